@@ -0,0 +1,69 @@
+// This demo requires a modified ESP8266 Arduino, found here:
+// https://github.com/Adam5Wu/Arduino
+
+// Measures name lookup time in a directory full of long file names.
+// Each round looks up every file once with its original name, once with
+// a different letter case, and once with a name that does not exist.
+
+#define NO_GLOBAL_SPIFFS
+
+#include <FS.h>
+#include <vfatfs_api.h>
+
+#define BENCH_DIR   "/lookup"
+#define BENCH_FILES 200
+#define BENCH_ROUNDS 5
+
+String benchName(int idx, bool upper) {
+  char name[64];
+  sprintf(name, BENCH_DIR "/Sensor Reading %04d - Living Room.csv", idx);
+  String ret(name);
+  if (upper) ret.toUpperCase();
+  return ret;
+}
+
+uint32_t benchRound(bool upper, bool missing) {
+  uint32_t start = micros();
+  for (int i = 0; i < BENCH_FILES; i++) {
+    String name = benchName(missing? i + BENCH_FILES : i, upper);
+    if (VFATFS.exists(name.c_str()) == missing) {
+      Serial.printf("Unexpected result for '%s'\n", name.c_str());
+    }
+  }
+  return micros() - start;
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  while (!VFATFS.begin()) panic();
+
+  if (!VFATFS.exists(BENCH_DIR)) {
+    Serial.printf("Creating %d files...\n", BENCH_FILES);
+    VFATFS.openDir(BENCH_DIR, true);
+    for (int i = 0; i < BENCH_FILES; i++) {
+      String name = benchName(i, false);
+      File f = VFATFS.open(name.c_str(), (OpenMode)(OM_CREATE | OM_TRUNCATE), AM_WRITE);
+      if (!f) {
+        Serial.printf("Unable to create '%s'\n", name.c_str());
+        return;
+      }
+    }
+  }
+
+  uint32_t same = 0, folded = 0, missing = 0;
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    same += benchRound(false, false);
+    folded += benchRound(true, false);
+    missing += benchRound(false, true);
+  }
+
+  uint32_t count = BENCH_FILES * BENCH_ROUNDS;
+  Serial.printf("Lookup (exact name): %u us\n", same / count);
+  Serial.printf("Lookup (case folded): %u us\n", folded / count);
+  Serial.printf("Lookup (missing): %u us\n", missing / count);
+}
+
+void loop() {
+  delay(5000);
+}
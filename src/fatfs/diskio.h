@@ -73,6 +73,9 @@ DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff);
 #define ATA_GET_MODEL		21	/* Get model name */
 #define ATA_GET_SN			22	/* Get serial number */
 
+/* Embedded flash specific ioctl command */
+#define CTRL_CACHE_BYPASS	30	/* Set (*(BYTE*)buff != 0) or clear bypass of the driver sector cache */
+
 #ifdef __cplusplus
 }
 #endif
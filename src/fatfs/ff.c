@@ -243,6 +243,24 @@
 #endif
 
 
+/* Free cluster bitmap */
+#if FF_FREE_BITMAP != 0 && FF_FS_READONLY
+#error FF_FREE_BITMAP must be 0 at read-only configuration
+#endif
+
+
+/* Directory hash index */
+#if FF_DIR_INDEX != 0 && FF_USE_LFN == 0
+#error FF_DIR_INDEX requires LFN enabled
+#endif
+
+
+/* Path lookup cache */
+#if (FF_PATH_CACHE != 0 || FF_NEG_CACHE != 0) && FF_USE_LFN == 0
+#error FF_PATH_CACHE and FF_NEG_CACHE require LFN enabled
+#endif
+
+
 /* File lock controls */
 #if FF_FS_LOCK != 0
 #if FF_FS_READONLY
@@ -1085,6 +1103,270 @@ FRESULT move_window (	/* Returns FR_OK or FR_DISK_ERR */
 
 
 
+#if FF_FAT_MIRROR || FF_FAT_CACHE
+/*-----------------------------------------------------------------------*/
+/* Bypass sector cache of the lower layer                                */
+/*-----------------------------------------------------------------------*/
+
+static
+void fat_bypass (	/* FAT sectors buffered by FatFs are not to be cached again */
+	FATFS* fs,		/* Filesystem object */
+	BYTE on			/* 1:Bypass, 0:Cache as usual */
+)
+{
+	disk_ioctl(fs->pdrv, CTRL_CACHE_BYPASS, &on);	/* Drivers without a cache ignore it */
+}
+#endif
+
+
+
+
+#if FF_FAT_MIRROR
+/*-----------------------------------------------------------------------*/
+/* Load/Flush in-memory FAT mirror                                       */
+/*-----------------------------------------------------------------------*/
+
+static
+void free_mirror (
+	FATFS* fs		/* Filesystem object */
+)
+{
+	if (fs->fatmir) {
+		ff_memfree(fs->fatmir);
+		fs->fatmir = 0;
+	}
+}
+
+
+static
+void load_mirror (	/* Leaves the FAT not mirrored on any failure */
+	FATFS* fs		/* Filesystem object */
+)
+{
+	DWORD szb;
+	UINT nsect;
+	DRESULT res;
+
+
+	free_mirror(fs);
+	switch (fs->fs_type) {	/* Size of the FAT entries [byte] */
+	case FS_FAT12 :
+		szb = fs->n_fatent * 3 / 2 + (fs->n_fatent & 1); break;
+	case FS_FAT16 :
+		szb = fs->n_fatent * 2; break;
+	case FS_FAT32 :
+		szb = fs->n_fatent * 4; break;
+	default :
+		return;
+	}
+	nsect = (szb + SS(fs) - 1) / SS(fs);
+	if ((DWORD)nsect * SS(fs) > FF_FAT_MIRROR) return;	/* Over the heap budget? */
+
+	fs->fatmir = ff_memalloc(nsect * SS(fs) + (nsect + 7) / 8);
+	if (!fs->fatmir) return;
+	fat_bypass(fs, 1);
+	res = disk_read(fs->pdrv, fs->fatmir, fs->fatbase, nsect);
+	fat_bypass(fs, 0);
+	if (res != RES_OK) {
+		free_mirror(fs);
+		return;
+	}
+	mem_set(fs->fatmir + nsect * SS(fs), 0, (nsect + 7) / 8);	/* Clear dirty sector map */
+	fs->n_fatmir = (WORD)nsect;
+}
+
+
+#if !FF_FS_READONLY
+static
+void dirty_mirror (
+	FATFS* fs,		/* Filesystem object */
+	UINT ofs		/* Byte offset of the modified FAT entry */
+)
+{
+	ofs /= SS(fs);
+	fs->fatmir[fs->n_fatmir * SS(fs) + ofs / 8] |= 1 << (ofs % 8);
+}
+
+
+static
+FRESULT sync_mirror (	/* Returns FR_OK or FR_DISK_ERR */
+	FATFS* fs		/* Filesystem object */
+)
+{
+	BYTE *dmap;
+	UINT i, j;
+
+
+	if (!fs->fatmir) return FR_OK;
+	dmap = fs->fatmir + fs->n_fatmir * SS(fs);
+	fat_bypass(fs, 1);
+	for (i = j = 0; i < fs->n_fatmir; i = j) {
+		for ( ; i < fs->n_fatmir && !(dmap[i / 8] & 1 << (i % 8)); i++) ;	/* Find a dirty sector */
+		for (j = i; j < fs->n_fatmir && (dmap[j / 8] & 1 << (j % 8)); j++) ;	/* Find end of the dirty run */
+		if (j == i) break;
+		if (disk_write(fs->pdrv, fs->fatmir + i * SS(fs), fs->fatbase + i, j - i) != RES_OK) break;	/* Write back the run */
+		if (fs->n_fats == 2) disk_write(fs->pdrv, fs->fatmir + i * SS(fs), fs->fatbase + fs->fsize + i, j - i);	/* Reflect it to 2nd FAT if needed */
+		for ( ; i < j; i++) dmap[i / 8] &= ~(1 << (i % 8));
+	}
+	fat_bypass(fs, 0);
+	return (i < j) ? FR_DISK_ERR : FR_OK;
+}
+#endif
+#endif	/* FF_FAT_MIRROR */
+
+
+
+
+#if FF_FAT_CACHE
+/*-----------------------------------------------------------------------*/
+/* Load/Flush FAT sector cache                                           */
+/*-----------------------------------------------------------------------*/
+
+static
+void free_fatcache (
+	FATFS* fs		/* Filesystem object */
+)
+{
+	if (fs->fcbuf) {
+		ff_memfree(fs->fcbuf);
+		fs->fcbuf = 0;
+	}
+}
+
+
+static
+void init_fatcache (	/* Leaves FAT accessed through win[] on failure */
+	FATFS* fs		/* Filesystem object */
+)
+{
+	UINT i;
+
+
+	free_fatcache(fs);
+#if FF_FAT_MIRROR
+	if (fs->fatmir) return;	/* No need for cache on mirrored FAT */
+#endif
+	fs->fcbuf = ff_memalloc(FF_FAT_CACHE * SS(fs));
+	for (i = 0; i < FF_FAT_CACHE; i++) {
+		fs->fcsect[i] = 0xFFFFFFFF;
+		fs->fcord[i] = (BYTE)i;
+	}
+	fs->fcdirty = 0;
+	fs->fc_hit = fs->fc_miss = fs->fc_wback = 0;
+}
+
+
+static
+FRESULT sync_fatcbuf (	/* Returns FR_OK or FR_DISK_ERR */
+	FATFS* fs,		/* Filesystem object */
+	UINT n			/* Index of the cache buffer */
+)
+{
+#if !FF_FS_READONLY
+	BYTE *buf = fs->fcbuf + n * SS(fs);
+	DRESULT res;
+
+
+	if (fs->fcdirty & 1 << n) {	/* Is the cache buffer dirty? */
+		fat_bypass(fs, 1);
+		res = disk_write(fs->pdrv, buf, fs->fcsect[n], 1);
+		if (res == RES_OK && fs->n_fats == 2) disk_write(fs->pdrv, buf, fs->fcsect[n] + fs->fsize, 1);	/* Reflect it to 2nd FAT if needed */
+		fat_bypass(fs, 0);
+		if (res != RES_OK) return FR_DISK_ERR;
+		fs->fcdirty &= ~(1 << n);
+		fs->fc_wback++;
+	}
+#endif
+	return FR_OK;
+}
+
+
+#if !FF_FS_READONLY
+static
+FRESULT sync_fatcache (	/* Returns FR_OK or FR_DISK_ERR */
+	FATFS* fs		/* Filesystem object */
+)
+{
+	UINT i;
+
+
+	if (fs->fcbuf) {
+		for (i = 0; i < FF_FAT_CACHE; i++) {
+			if (sync_fatcbuf(fs, i) != FR_OK) return FR_DISK_ERR;
+		}
+	}
+	return FR_OK;
+}
+#endif
+
+
+static
+BYTE* load_fatcache (	/* Pointer to the cached FAT sector, NULL:disk error */
+	FATFS* fs,		/* Filesystem object */
+	DWORD sector	/* FAT sector to be loaded */
+)
+{
+	UINT i, n;
+	DRESULT res;
+
+
+	for (i = 0; i < FF_FAT_CACHE && fs->fcsect[fs->fcord[i]] != sector; i++) ;
+	if (i < FF_FAT_CACHE) {		/* Cache hit? */
+		fs->fc_hit++;
+		n = fs->fcord[i];
+	} else {					/* Cache miss: reuse the least recently used buffer */
+		i = FF_FAT_CACHE - 1;
+		n = fs->fcord[i];
+		if (sync_fatcbuf(fs, n) != FR_OK) return 0;
+		fs->fc_miss++;
+		fat_bypass(fs, 1);
+		res = disk_read(fs->pdrv, fs->fcbuf + n * SS(fs), sector, 1);
+		fat_bypass(fs, 0);
+		if (res != RES_OK) {
+			fs->fcsect[n] = 0xFFFFFFFF;	/* Invalidate buffer if read data is not valid */
+			return 0;
+		}
+		fs->fcsect[n] = sector;
+	}
+	for ( ; i > 0; i--) fs->fcord[i] = fs->fcord[i - 1];	/* Move it to the front */
+	fs->fcord[0] = (BYTE)n;
+	return fs->fcbuf + n * SS(fs);
+}
+#endif	/* FF_FAT_CACHE */
+
+
+static
+BYTE* fat_window (	/* Pointer to the FAT sector data, NULL:disk error */
+	FATFS* fs,		/* Filesystem object */
+	DWORD sector	/* FAT sector to be accessed */
+)
+{
+#if FF_FAT_CACHE
+	if (fs->fcbuf) return load_fatcache(fs, sector);
+#endif
+	return (move_window(fs, sector) == FR_OK) ? fs->win : 0;
+}
+
+
+#if !FF_FS_READONLY
+static
+void fat_dirty (	/* Mark the FAT sector last accessed by fat_window() dirty */
+	FATFS* fs		/* Filesystem object */
+)
+{
+#if FF_FAT_CACHE
+	if (fs->fcbuf) {
+		fs->fcdirty |= 1 << fs->fcord[0];
+		return;
+	}
+#endif
+	fs->wflag = 1;
+}
+#endif
+
+
+
+
 #if !FF_FS_READONLY
 /*-----------------------------------------------------------------------*/
 /* Synchronize filesystem and data on the storage                        */
@@ -1099,8 +1381,20 @@ FRESULT sync_fs (	/* Returns FR_OK or FR_DISK_ERR */
 
 
 	res = sync_window(fs);
+#if FF_FAT_MIRROR
+	if (res == FR_OK) res = sync_mirror(fs);	/* Write back modified FAT sectors */
+#endif
+#if FF_FAT_CACHE
+	if (res == FR_OK) res = sync_fatcache(fs);	/* Write back cached FAT sectors */
+#endif
 	if (res == FR_OK) {
+#if !FF_ALLOC_SUMMARY
 		if (fs->fs_type == FS_FAT32 && fs->fsi_flag == 1) {	/* FAT32: Update FSInfo sector if needed */
+#else
+		if ((fs->fsi_flag & 0x81) == 1) {	/* Update FSInfo sector or allocation summary if needed */
+#endif
+			/* The FAT must reach the media before the counts that describe it */
+			if (disk_ioctl(fs->pdrv, CTRL_SYNC, 0) != RES_OK) return FR_DISK_ERR;
 			/* Create FSInfo structure */
 			mem_set(fs->win, 0, SS(fs));
 			st_word(fs->win + BS_55AA, 0xAA55);
@@ -1111,7 +1405,11 @@ FRESULT sync_fs (	/* Returns FR_OK or FR_DISK_ERR */
 			/* Write it into the FSInfo sector */
 			fs->winsect = fs->volbase + 1;
 			disk_write(fs->pdrv, fs->win, fs->winsect, 1);
+#if !FF_ALLOC_SUMMARY
 			fs->fsi_flag = 0;
+#else
+			fs->fsi_flag = (fs->free_clst <= fs->n_fatent - 2) ? 2 : 0;	/* Record on the disk is valid until the next FAT change */
+#endif
 		}
 		/* Make sure that no pending write process in the lower layer */
 		if (disk_ioctl(fs->pdrv, CTRL_SYNC, 0) != RES_OK) res = FR_DISK_ERR;
@@ -1120,6 +1418,35 @@ FRESULT sync_fs (	/* Returns FR_OK or FR_DISK_ERR */
 	return res;
 }
 
+
+
+#if FF_ALLOC_SUMMARY
+/*-----------------------------------------------------------------------*/
+/* Invalidate allocation summary on the storage                          */
+/*-----------------------------------------------------------------------*/
+
+static
+FRESULT inval_summary (	/* Returns FR_OK or FR_DISK_ERR */
+	FATFS* fs		/* Filesystem object */
+)
+{
+	FRESULT res;
+
+
+	res = move_window(fs, fs->volbase + 1);	/* Load the FSInfo / summary sector */
+	if (res == FR_OK) {
+		st_dword(fs->win + FSI_Free_Count, 0xFFFFFFFF);	/* Mark the counts unknown */
+		st_dword(fs->win + FSI_Nxt_Free, 0xFFFFFFFF);
+		fs->wflag = 1;
+		res = sync_window(fs);
+		/* The mark must reach the media before any FAT sector does */
+		if (res == FR_OK && disk_ioctl(fs->pdrv, CTRL_SYNC, 0) != RES_OK) res = FR_DISK_ERR;
+		if (res == FR_OK) fs->fsi_flag &= ~2;
+	}
+	return res;
+}
+#endif
+
 #endif
 
 
@@ -1153,6 +1480,7 @@ DWORD get_fat (		/* 0xFFFFFFFF:Disk error, 1:Internal error, 2..0x7FFFFFFF:Clust
 )
 {
 	UINT wc, bc;
+	BYTE *p;
 	DWORD val;
 	FATFS *fs = obj->fs;
 
@@ -1160,27 +1488,45 @@ DWORD get_fat (		/* 0xFFFFFFFF:Disk error, 1:Internal error, 2..0x7FFFFFFF:Clust
 	if (clst < 2 || clst >= fs->n_fatent) {	/* Check if in valid range */
 		val = 1;	/* Internal error */
 
+#if FF_FAT_MIRROR
+	} else if (fs->fatmir) {	/* Get it from the FAT mirror */
+		switch (fs->fs_type) {
+		case FS_FAT12 :
+			bc = (UINT)clst; bc += bc / 2;
+			wc = ld_word(fs->fatmir + bc);
+			val = (clst & 1) ? (wc >> 4) : (wc & 0xFFF);	/* Adjust bit position */
+			break;
+
+		case FS_FAT16 :
+			val = ld_word(fs->fatmir + clst * 2);
+			break;
+
+		default :	/* FS_FAT32 */
+			val = ld_dword(fs->fatmir + clst * 4) & 0x0FFFFFFF;
+		}
+
+#endif
 	} else {
 		val = 0xFFFFFFFF;	/* Default value falls on disk error */
 
 		switch (fs->fs_type) {
 		case FS_FAT12 :
 			bc = (UINT)clst; bc += bc / 2;
-			if (move_window(fs, fs->fatbase + (bc / SS(fs))) != FR_OK) break;
-			wc = fs->win[bc++ % SS(fs)];		/* Get 1st byte of the entry */
-			if (move_window(fs, fs->fatbase + (bc / SS(fs))) != FR_OK) break;
-			wc |= fs->win[bc % SS(fs)] << 8;	/* Merge 2nd byte of the entry */
+			if ((p = fat_window(fs, fs->fatbase + (bc / SS(fs)))) == 0) break;
+			wc = p[bc++ % SS(fs)];				/* Get 1st byte of the entry */
+			if ((p = fat_window(fs, fs->fatbase + (bc / SS(fs)))) == 0) break;
+			wc |= p[bc % SS(fs)] << 8;			/* Merge 2nd byte of the entry */
 			val = (clst & 1) ? (wc >> 4) : (wc & 0xFFF);	/* Adjust bit position */
 			break;
 
 		case FS_FAT16 :
-			if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 2))) != FR_OK) break;
-			val = ld_word(fs->win + clst * 2 % SS(fs));		/* Simple WORD array */
+			if ((p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 2)))) == 0) break;
+			val = ld_word(p + clst * 2 % SS(fs));		/* Simple WORD array */
 			break;
 
 		case FS_FAT32 :
-			if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 4))) != FR_OK) break;
-			val = ld_dword(fs->win + clst * 4 % SS(fs)) & 0x0FFFFFFF;	/* Simple DWORD array but mask out upper 4 bits */
+			if ((p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 4)))) == 0) break;
+			val = ld_dword(p + clst * 4 % SS(fs)) & 0x0FFFFFFF;	/* Simple DWORD array but mask out upper 4 bits */
 			break;
 #if FF_FS_EXFAT
 		case FS_EXFAT :
@@ -1200,8 +1546,8 @@ DWORD get_fat (		/* 0xFFFFFFFF:Disk error, 1:Internal error, 2..0x7FFFFFFF:Clust
 					if (obj->n_frag != 0) {	/* Is it on the growing edge? */
 						val = 0x7FFFFFFF;	/* Generate EOC */
 					} else {
-						if (move_window(fs, fs->fatbase + (clst / (SS(fs) / 4))) != FR_OK) break;
-						val = ld_dword(fs->win + clst * 4 % SS(fs)) & 0x7FFFFFFF;
+						if ((p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 4)))) == 0) break;
+						val = ld_dword(p + clst * 4 % SS(fs)) & 0x7FFFFFFF;
 					}
 					break;
 				}
@@ -1237,41 +1583,84 @@ FRESULT put_fat (	/* FR_OK(0):succeeded, !=0:error */
 
 
 	if (clst >= 2 && clst < fs->n_fatent) {	/* Check if in valid range */
+#if FF_ALLOC_SUMMARY
+		if (fs->fsi_flag & 2) {	/* First FAT change after sync: the summary on the disk becomes stale */
+			res = inval_summary(fs);
+			if (res != FR_OK) return res;
+		}
+#endif
+#if FF_FAT_MIRROR
+		if (fs->fatmir) {	/* Change it in the FAT mirror, written back at sync */
+			switch (fs->fs_type) {
+			case FS_FAT12 :
+				bc = (UINT)clst; bc += bc / 2;	/* bc: byte offset of the entry */
+				p = fs->fatmir + bc;
+				p[0] = (clst & 1) ? ((p[0] & 0x0F) | ((BYTE)val << 4)) : (BYTE)val;		/* Put 1st byte */
+				p[1] = (clst & 1) ? (BYTE)(val >> 4) : ((p[1] & 0xF0) | ((BYTE)(val >> 8) & 0x0F));	/* Put 2nd byte */
+				dirty_mirror(fs, bc); dirty_mirror(fs, bc + 1);
+				break;
+
+			case FS_FAT16 :
+				bc = (UINT)clst * 2;
+				st_word(fs->fatmir + bc, (WORD)val);
+				dirty_mirror(fs, bc);
+				break;
+
+			default :	/* FS_FAT32 */
+				bc = (UINT)clst * 4;
+				st_dword(fs->fatmir + bc, (val & 0x0FFFFFFF) | (ld_dword(fs->fatmir + bc) & 0xF0000000));
+				dirty_mirror(fs, bc);
+			}
+			res = FR_OK;
+		} else
+#endif
 		switch (fs->fs_type) {
 		case FS_FAT12 :
 			bc = (UINT)clst; bc += bc / 2;	/* bc: byte offset of the entry */
-			res = move_window(fs, fs->fatbase + (bc / SS(fs)));
-			if (res != FR_OK) break;
-			p = fs->win + bc++ % SS(fs);
+			res = FR_DISK_ERR;
+			if ((p = fat_window(fs, fs->fatbase + (bc / SS(fs)))) == 0) break;
+			p += bc++ % SS(fs);
 			*p = (clst & 1) ? ((*p & 0x0F) | ((BYTE)val << 4)) : (BYTE)val;		/* Put 1st byte */
-			fs->wflag = 1;
-			res = move_window(fs, fs->fatbase + (bc / SS(fs)));
-			if (res != FR_OK) break;
-			p = fs->win + bc % SS(fs);
+			fat_dirty(fs);
+			if ((p = fat_window(fs, fs->fatbase + (bc / SS(fs)))) == 0) break;
+			p += bc % SS(fs);
 			*p = (clst & 1) ? (BYTE)(val >> 4) : ((*p & 0xF0) | ((BYTE)(val >> 8) & 0x0F));	/* Put 2nd byte */
-			fs->wflag = 1;
+			fat_dirty(fs);
+			res = FR_OK;
 			break;
 
 		case FS_FAT16 :
-			res = move_window(fs, fs->fatbase + (clst / (SS(fs) / 2)));
-			if (res != FR_OK) break;
-			st_word(fs->win + clst * 2 % SS(fs), (WORD)val);	/* Simple WORD array */
-			fs->wflag = 1;
+			res = FR_DISK_ERR;
+			if ((p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 2)))) == 0) break;
+			st_word(p + clst * 2 % SS(fs), (WORD)val);	/* Simple WORD array */
+			fat_dirty(fs);
+			res = FR_OK;
 			break;
 
 		case FS_FAT32 :
 #if FF_FS_EXFAT
 		case FS_EXFAT :
 #endif
-			res = move_window(fs, fs->fatbase + (clst / (SS(fs) / 4)));
-			if (res != FR_OK) break;
+			res = FR_DISK_ERR;
+			if ((p = fat_window(fs, fs->fatbase + (clst / (SS(fs) / 4)))) == 0) break;
+			p += clst * 4 % SS(fs);
 			if (!FF_FS_EXFAT || fs->fs_type != FS_EXFAT) {
-				val = (val & 0x0FFFFFFF) | (ld_dword(fs->win + clst * 4 % SS(fs)) & 0xF0000000);
+				val = (val & 0x0FFFFFFF) | (ld_dword(p) & 0xF0000000);
 			}
-			st_dword(fs->win + clst * 4 % SS(fs), val);
-			fs->wflag = 1;
+			st_dword(p, val);
+			fat_dirty(fs);
+			res = FR_OK;
 			break;
 		}
+#if FF_FREE_BITMAP
+		if (res == FR_OK && fs->fbmp) {	/* Reflect the change to the free cluster bitmap */
+			if (val & 0x0FFFFFFF) {
+				fs->fbmp[clst / 32] |= (DWORD)1 << (clst % 32);
+			} else {
+				fs->fbmp[clst / 32] &= ~((DWORD)1 << (clst % 32));
+			}
+		}
+#endif
 	}
 	return res;
 }
@@ -1281,55 +1670,151 @@ FRESULT put_fat (	/* FR_OK(0):succeeded, !=0:error */
 
 
 
-#if FF_FS_EXFAT && !FF_FS_READONLY
+#if FF_FREE_BITMAP
 /*-----------------------------------------------------------------------*/
-/* exFAT: Accessing FAT and Allocation Bitmap                            */
+/* FAT handling - Free cluster bitmap                                    */
 /*-----------------------------------------------------------------------*/
 
-/*--------------------------------------*/
-/* Find a contiguous free cluster block */
-/*--------------------------------------*/
-
 static
-DWORD find_bitmap (	/* 0:Not found, 2..:Cluster block found, 0xFFFFFFFF:Disk error */
-	FATFS* fs,	/* Filesystem object */
-	DWORD clst,	/* Cluster number to scan from */
-	DWORD ncl	/* Number of contiguous clusters to find (1..) */
+void free_fbmp (
+	FATFS* fs		/* Filesystem object */
 )
 {
-	BYTE bm, bv;
-	UINT i;
-	DWORD val, scl, ctr;
-
-
-	clst -= 2;	/* The first bit in the bitmap corresponds to cluster #2 */
-	if (clst >= fs->n_fatent - 2) clst = 0;
-	scl = val = clst; ctr = 0;
-	for (;;) {
-		if (move_window(fs, fs->database + val / 8 / SS(fs)) != FR_OK) return 0xFFFFFFFF;	/* (assuming bitmap is located top of the cluster heap) */
-		i = val / 8 % SS(fs); bm = 1 << (val % 8);
-		do {
-			do {
-				bv = fs->win[i] & bm; bm <<= 1;		/* Get bit value */
-				if (++val >= fs->n_fatent - 2) {	/* Next cluster (with wrap-around) */
-					val = 0; bm = 0; i = SS(fs);
-				}
-				if (bv == 0) {	/* Is it a free cluster? */
-					if (++ctr == ncl) return scl + 2;	/* Check if run length is sufficient for required */
-				} else {
-					scl = val; ctr = 0;		/* Encountered a cluster in-use, restart to scan */
-				}
-				if (val == clst) return 0;	/* All cluster scanned? */
-			} while (bm != 0);
-			bm = 1;
-		} while (++i < SS(fs));
+	if (fs->fbmp) {
+		ff_memfree(fs->fbmp);
+		fs->fbmp = 0;
 	}
 }
 
 
-/*----------------------------------------*/
-/* Set/Clear a block of allocation bitmap */
-/*----------------------------------------*/
+static
+void load_fbmp (	/* Leaves the bitmap not built on any failure */
+	FATFS* fs		/* Filesystem object */
+)
+{
+	DWORD clst, stat, nfree, w;
+	UINT i, nw;
+	FFOBJID obj;
+
+
+	if (fs->fbmp) return;					/* Already built? */
+	if (FF_FS_EXFAT && fs->fs_type == FS_EXFAT) return;	/* exFAT has its own bitmap */
+	nw = (UINT)((fs->n_fatent + 31) / 32);	/* Number of bitmap words */
+	if ((DWORD)nw * 4 > FF_FREE_BITMAP) return;	/* Over the heap budget? */
+	fs->fbmp = ff_memalloc(nw * sizeof (DWORD));
+	if (!fs->fbmp) return;
+
+	for (i = 0; i < nw; i++) fs->fbmp[i] = 0xFFFFFFFF;	/* Reserved clusters and tail are in use */
+	obj.fs = fs;
+	for (clst = 2; clst < fs->n_fatent; clst++) {	/* Clear the bit of every free cluster */
+		stat = get_fat(&obj, clst);
+		if (stat == 1 || stat == 0xFFFFFFFF) {
+			free_fbmp(fs);
+			return;
+		}
+		if (stat == 0) fs->fbmp[clst / 32] &= ~((DWORD)1 << (clst % 32));
+	}
+	for (nfree = 0, i = 0; i < nw; i++) {	/* Count zero bits */
+		for (w = ~fs->fbmp[i] & 0xFFFFFFFF; w; w &= w - 1) nfree++;
+	}
+	fs->free_clst = nfree;		/* Now free_clst is valid */
+	fs->fsi_flag |= 1;
+}
+
+
+static
+DWORD count_fbmp (	/* Number of free clusters */
+	FATFS* fs		/* Filesystem object */
+)
+{
+	DWORD nfree = 0, w;
+	UINT i, nw = (UINT)((fs->n_fatent + 31) / 32);
+
+
+	for (i = 0; i < nw; i++) {
+		for (w = ~fs->fbmp[i] & 0xFFFFFFFF; w; w &= w - 1) nfree++;	/* Count zero bits */
+	}
+	return nfree;
+}
+
+
+static
+DWORD find_fbmp (	/* 0:No free cluster, >=2:Free cluster# */
+	FATFS* fs,		/* Filesystem object */
+	DWORD scl		/* Cluster to start to find after */
+)
+{
+	DWORD clst, w;
+	UINT i, nw = (UINT)((fs->n_fatent + 31) / 32);
+
+
+	clst = scl + 1;
+	if (clst >= fs->n_fatent) clst = 2;
+	for (i = 0; i <= nw; i++) {	/* Visit each word, and the first one again after wrap-around */
+		w = (~fs->fbmp[clst / 32] & 0xFFFFFFFF) >> (clst % 32);	/* Free bits from clst */
+		if (w) {
+			for ( ; !(w & 1); w >>= 1) clst++;
+			return clst;
+		}
+		clst = (clst / 32 + 1) * 32;	/* Top of next word */
+		if (clst >= fs->n_fatent) clst = 0;	/* Wrap-around (cluster 0 and 1 are in use) */
+	}
+	return 0;
+}
+#endif	/* FF_FREE_BITMAP */
+
+
+
+
+#if FF_FS_EXFAT && !FF_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* exFAT: Accessing FAT and Allocation Bitmap                            */
+/*-----------------------------------------------------------------------*/
+
+/*--------------------------------------*/
+/* Find a contiguous free cluster block */
+/*--------------------------------------*/
+
+static
+DWORD find_bitmap (	/* 0:Not found, 2..:Cluster block found, 0xFFFFFFFF:Disk error */
+	FATFS* fs,	/* Filesystem object */
+	DWORD clst,	/* Cluster number to scan from */
+	DWORD ncl	/* Number of contiguous clusters to find (1..) */
+)
+{
+	BYTE bm, bv;
+	UINT i;
+	DWORD val, scl, ctr;
+
+
+	clst -= 2;	/* The first bit in the bitmap corresponds to cluster #2 */
+	if (clst >= fs->n_fatent - 2) clst = 0;
+	scl = val = clst; ctr = 0;
+	for (;;) {
+		if (move_window(fs, fs->database + val / 8 / SS(fs)) != FR_OK) return 0xFFFFFFFF;	/* (assuming bitmap is located top of the cluster heap) */
+		i = val / 8 % SS(fs); bm = 1 << (val % 8);
+		do {
+			do {
+				bv = fs->win[i] & bm; bm <<= 1;		/* Get bit value */
+				if (++val >= fs->n_fatent - 2) {	/* Next cluster (with wrap-around) */
+					val = 0; bm = 0; i = SS(fs);
+				}
+				if (bv == 0) {	/* Is it a free cluster? */
+					if (++ctr == ncl) return scl + 2;	/* Check if run length is sufficient for required */
+				} else {
+					scl = val; ctr = 0;		/* Encountered a cluster in-use, restart to scan */
+				}
+				if (val == clst) return 0;	/* All cluster scanned? */
+			} while (bm != 0);
+			bm = 1;
+		} while (++i < SS(fs));
+	}
+}
+
+
+/*----------------------------------------*/
+/* Set/Clear a block of allocation bitmap */
+/*----------------------------------------*/
 
 static
 FRESULT change_bitmap (
@@ -1565,6 +2050,9 @@ DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:Disk err
 #endif
 	{	/* On the FAT/FAT32 volume */
 		ncl = 0;
+#if FF_FREE_BITMAP
+		load_fbmp(fs);							/* Build free cluster bitmap at the first allocation */
+#endif
 		if (scl == clst) {						/* Stretching an existing chain? */
 			ncl = scl + 1;						/* Test if next cluster is free */
 			if (ncl >= fs->n_fatent) ncl = 2;
@@ -1576,6 +2064,12 @@ DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:Disk err
 				ncl = 0;
 			}
 		}
+#if FF_FREE_BITMAP
+		if (ncl == 0 && fs->fbmp) {	/* Find a free cluster on the bitmap */
+			ncl = find_fbmp(fs, scl);
+			if (ncl == 0) return 0;		/* No free cluster found? */
+		}
+#endif
 		if (ncl == 0) {	/* The new cluster cannot be contiguous and find another fragment */
 			ncl = scl;	/* Start cluster */
 			for (;;) {
@@ -1607,6 +2101,161 @@ DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:Disk err
 	return ncl;		/* Return new cluster number or error status */
 }
 
+
+
+
+#if FF_EXTENT_ALLOC
+/*-----------------------------------------------------------------------*/
+/* FAT handling - Allocate contiguous extents for a file                 */
+/*-----------------------------------------------------------------------*/
+
+static
+DWORD clst_used (	/* 0:Free, 1:Internal error, 0xFFFFFFFF:Disk error, else:In use */
+	FFOBJID* obj,	/* Corresponding object */
+	DWORD clst		/* Cluster# to test */
+)
+{
+#if FF_FREE_BITMAP
+	if (obj->fs->fbmp) return (obj->fs->fbmp[clst / 32] >> (clst % 32)) & 1 ? 2 : 0;
+#endif
+	return get_fat(obj, clst);
+}
+
+
+static
+DWORD find_extent (	/* 0:No free cluster, 0xFFFFFFFF:Disk error, >=2:Top of the free run */
+	FFOBJID* obj,	/* Corresponding object */
+	DWORD* ncl		/* Number of clusters wanted [in], found [out] */
+)
+{
+	FATFS *fs = obj->fs;
+	DWORD clst, cs, top = 0, run = 0, best = 0, blen = 0;
+
+
+	for (clst = 2; clst <= fs->n_fatent; clst++) {
+		if (clst < fs->n_fatent) {
+			cs = clst_used(obj, clst);
+			if (cs == 1 || cs == 0xFFFFFFFF) return 0xFFFFFFFF;
+			if (cs == 0) {				/* Free cluster: extend current run */
+				if (run++ == 0) top = clst;
+				continue;
+			}
+		}
+		if (run) {	/* End of a free run: keep the smallest run that fits, else the largest one */
+			if (run >= *ncl ? (blen < *ncl || run < blen) : (blen < *ncl && run > blen)) {
+				best = top; blen = run;
+			}
+			if (blen == *ncl) break;	/* Exact fit */
+			run = 0;
+		}
+	}
+	if (blen < *ncl) *ncl = blen;
+	return best;
+}
+
+
+static
+DWORD extent_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:Disk error, >=2:New cluster# */
+	FIL* fp,		/* File object */
+	DWORD clst,		/* Cluster# to stretch, 0:Create a new chain */
+	UINT btw		/* Number of bytes left in the write request */
+)
+{
+	FATFS *fs = fp->obj.fs;
+	DWORD cs, ncl, n, i;
+	FRESULT res;
+
+
+	if (clst != 0) {
+		cs = get_fat(&fp->obj, clst);		/* Check the cluster status */
+		if (cs < 2) return 1;				/* Test for insanity */
+		if (cs == 0xFFFFFFFF || cs < fs->n_fatent) return cs;	/* Disk error or already followed by an extent */
+	}
+	if (FF_FS_EXFAT && fs->fs_type == FS_EXFAT) return create_chain(&fp->obj, clst);
+
+	n = (btw + (DWORD)fs->csize * SS(fs) - 1) / ((DWORD)fs->csize * SS(fs));	/* Clusters needed by the request */
+	if (clst != 0 && fp->ext_len) {	/* Sequential writer: grow geometrically */
+		i = fp->ext_len * 2;
+		if (n < i) n = i;
+	}
+	if (n > FF_EXTENT_ALLOC) n = FF_EXTENT_ALLOC;
+	if (fs->free_clst <= fs->n_fatent - 2 && n > fs->free_clst) n = fs->free_clst;
+	if (n < 2) {	/* Single cluster is allocated as usual */
+		ncl = create_chain(&fp->obj, clst);
+		if (ncl >= 2 && ncl != 0xFFFFFFFF) fp->ext_len = 1;	/* Next stretch may take an extent */
+		return ncl;
+	}
+
+#if FF_FREE_BITMAP
+	load_fbmp(fs);
+#endif
+	ncl = 0;
+	if (clst != 0) {	/* Keep the file contiguous if the run after its end fits */
+		for (i = 1; i <= n && clst + i < fs->n_fatent; i++) {
+			cs = clst_used(&fp->obj, clst + i);
+			if (cs == 1 || cs == 0xFFFFFFFF) return cs;
+			if (cs != 0) break;
+		}
+		if (i > n) ncl = clst + 1;
+	}
+	if (ncl == 0) {		/* Best-fit over the free runs */
+		ncl = find_extent(&fp->obj, &n);
+		if (ncl == 0 || ncl == 0xFFFFFFFF) return ncl;
+	}
+
+	res = FR_OK;
+	for (i = 0; i < n && res == FR_OK; i++) {	/* Link the extent and terminate it */
+		res = put_fat(fs, ncl + i, (i + 1 < n) ? ncl + i + 1 : 0xFFFFFFFF);
+	}
+	if (res == FR_OK && clst != 0) {
+		res = put_fat(fs, clst, ncl);		/* Link it from the previous one if needed */
+	}
+	if (res != FR_OK) return (res == FR_DISK_ERR) ? 0xFFFFFFFF : 1;
+
+	fs->last_clst = ncl + n - 1;
+	if (fs->free_clst <= fs->n_fatent - 2) fs->free_clst -= n;
+	fs->fsi_flag |= 1;
+	fp->ext_len = n;
+	return ncl;
+}
+
+
+static
+FRESULT trim_extent (	/* Release the clusters beyond the file size */
+	FIL* fp			/* File object */
+)
+{
+	FATFS *fs = fp->obj.fs;
+	DWORD clst, ncl, bcs;
+	FSIZE_t ofs;
+	FRESULT res;
+
+
+	if (fp->obj.sclust == 0) return FR_OK;
+	if (fp->obj.objsize == 0) {		/* Nothing written: release the whole chain */
+		res = remove_chain(&fp->obj, fp->obj.sclust, 0);
+		fp->obj.sclust = 0;
+		fp->flag |= FA_MODIFIED;
+		return res;
+	}
+	if (fp->fptr == fp->obj.objsize) {	/* Current cluster holds the last byte */
+		clst = fp->clust;
+	} else {						/* Follow the chain to the last byte */
+		bcs = (DWORD)fs->csize * SS(fs);
+		clst = fp->obj.sclust;
+		for (ofs = bcs; ofs < fp->obj.objsize; ofs += bcs) {
+			clst = get_fat(&fp->obj, clst);
+			if (clst == 0xFFFFFFFF) return FR_DISK_ERR;
+			if (clst < 2 || clst >= fs->n_fatent) return FR_INT_ERR;
+		}
+	}
+	ncl = get_fat(&fp->obj, clst);
+	if (ncl == 0xFFFFFFFF) return FR_DISK_ERR;
+	if (ncl < 2) return FR_INT_ERR;
+	return (ncl < fs->n_fatent) ? remove_chain(&fp->obj, ncl, clst) : FR_OK;
+}
+#endif	/* FF_EXTENT_ALLOC */
+
 #endif /* !FF_FS_READONLY */
 
 
@@ -1876,6 +2525,24 @@ void st_clust (
 
 
 #if FF_USE_LFN
+/*--------------------------------------------------------*/
+/* FAT-LFN: Up-convert a character for name comparison    */
+/*--------------------------------------------------------*/
+/* Same result as ff_wtoupper(), but Basic Latin and Latin-1 are converted
+/  in place instead of searching the conversion tables in flash memory */
+static
+WCHAR up_lfn (		/* Returns up-converted character */
+	DWORD uni		/* Character to be up-converted */
+)
+{
+	if (uni < 0x100) {
+		if ((uni >= 'a' && uni <= 'z') || (uni >= 0xE0 && uni <= 0xFE && uni != 0xF7)) return (WCHAR)(uni - 0x20);
+		return (uni == 0xFF) ? 0x178 : (WCHAR)uni;
+	}
+	return (WCHAR)ff_wtoupper(uni);
+}
+
+
 /*--------------------------------------------------------*/
 /* FAT-LFN: Compare a part of file name with an LFN entry */
 /*--------------------------------------------------------*/
@@ -1886,7 +2553,7 @@ int cmp_lfn (				/* 1:matched, 0:not matched */
 )
 {
 	UINT i, s;
-	WCHAR wc, uc;
+	WCHAR wc, uc, lc;
 
 
 	if (ld_word(dir + LDIR_FstClusLO) != 0) return 0;	/* Check LDIR_FstClusLO */
@@ -1896,7 +2563,9 @@ int cmp_lfn (				/* 1:matched, 0:not matched */
 	for (wc = 1, s = 0; s < 13; s++) {		/* Process all characters in the entry */
 		uc = ld_word(dir + LfnOfs[s]);		/* Pick an LFN character */
 		if (wc != 0) {
-			if (i >= FF_MAX_LFN || ff_wtoupper(uc) != ff_wtoupper(lfnbuf[i++])) {	/* Compare it */
+			if (i >= FF_MAX_LFN) return 0;	/* Too long */
+			lc = lfnbuf[i++];
+			if (uc != lc && up_lfn(uc) != up_lfn(lc)) {	/* Compare it (identical characters need no conversion) */
 				return 0;					/* Not matched */
 			}
 			wc = uc;
@@ -1991,35 +2660,44 @@ void put_lfn (
 /* FAT-LFN: Create a Numbered SFN                                        */
 /*-----------------------------------------------------------------------*/
 
+#define NUM_SEQ		5	/* Number of sequential numbers tried before the hashed ones */
+#define NUM_WIN		59	/* Number of hashed numbers tried in a directory scan */
+
+static
+UINT hash_numname (	/* Returns base of the hashed numbers */
+	const WCHAR* lfn	/* Pointer to LFN */
+)
+{
+	UINT i;
+	WCHAR wc;
+	DWORD sr = 0;
+
+
+	while (*lfn) {	/* Create a CRC */
+		wc = *lfn++;
+		for (i = 0; i < 16; i++) {
+			sr = (sr << 1) + (wc & 1);
+			wc >>= 1;
+			if (sr & 0x10000) sr ^= 0x11021;
+		}
+	}
+	return (UINT)sr;
+}
+
+
 static
 void gen_numname (
 	BYTE* dst,			/* Pointer to the buffer to store numbered SFN */
 	const BYTE* src,	/* Pointer to SFN */
-	const WCHAR* lfn,	/* Pointer to LFN */
-	UINT seq			/* Sequence number */
+	UINT seq			/* Number to append (0..0xFFFF) */
 )
 {
 	BYTE ns[8], c;
 	UINT i, j;
-	WCHAR wc;
-	DWORD sr;
 
 
 	mem_cpy(dst, src, 11);
 
-	if (seq > 5) {	/* In case of many collisions, generate a hash number instead of sequential number */
-		sr = seq;
-		while (*lfn) {	/* Create a CRC */
-			wc = *lfn++;
-			for (i = 0; i < 16; i++) {
-				sr = (sr << 1) + (wc & 1);
-				wc >>= 1;
-				if (sr & 0x10000) sr ^= 0x11021;
-			}
-		}
-		seq = (UINT)sr;
-	}
-
 	/* itoa (hexdecimal) */
 	i = 7;
 	do {
@@ -2041,6 +2719,65 @@ void gen_numname (
 		dst[j++] = (i < 8) ? ns[i++] : ' ';
 	} while (j < 8);
 }
+
+
+static
+FRESULT dir_numname (	/* FR_OK:free numbered SFN is set to dp->fn, FR_DENIED:no free number, others:error */
+	DIR* dp,			/* Directory object to find a free numbered SFN in */
+	const BYTE* sn		/* Basis SFN */
+)
+{
+	FRESULT res;
+	FATFS *fs = dp->obj.fs;
+	BYTE c, a, tn[11], tp[5];
+	DWORD used[2];
+	UINT i, t, n, v, hash, base;
+
+
+	for (n = 1; n <= 4; n++) {	/* Position of '~' in the numbered SFN for each number of digits */
+		gen_numname(tn, sn, (UINT)1 << (n - 1) * 4);
+		for (t = 0; tn[t] != '~'; t++) ;
+		tp[n] = (BYTE)t;
+	}
+
+	/* Candidates are ~1..~5 and then NUM_WIN numbers from the hash of the LFN */
+	hash = hash_numname(fs->lfnbuf);
+	for (base = 0; base < 0x10000; base += NUM_WIN) {
+		used[0] = base ? (1 << NUM_SEQ) - 1 : 0; used[1] = 0;	/* Sequential numbers are tried in the first scan only */
+		res = dir_sdi(dp, 0);
+		while (res == FR_OK) {	/* Collect used candidates in a directory scan */
+			res = move_window(fs, dp->sect);
+			if (res != FR_OK) break;
+			c = dp->dir[DIR_Name];
+			if (c == 0) break;	/* Reached to end of table */
+			a = dp->dir[DIR_Attr] & AM_MASK;
+			if (c != DDEM && a != AM_LFN && !(a & AM_VOL)) {	/* An SFN entry */
+				for (n = 1; n <= 4; n++) {	/* Is it a numbered SFN with n digits derived from the basis name? */
+					t = tp[n];
+					if (dp->dir[t] != '~' || (t + n + 1 < 8 && dp->dir[t + n + 1] != ' ')) continue;
+					for (v = 0, i = t + 1; i <= t + n; i++) {	/* Get the hexdecimal number following '~' */
+						c = dp->dir[i];
+						if (IsDigit(c)) c -= '0'; else if (c >= 'A' && c <= 'F') c -= 'A' - 10; else break;
+						v = v * 16 + c;
+					}
+					if (i <= t + n || mem_cmp(dp->dir, sn, t) || mem_cmp(dp->dir + 8, sn + 8, 3)) continue;
+					if (v >= 1 && v <= NUM_SEQ) used[0] |= 1 << (v - 1);
+					v = (v - hash - base) & 0xFFFF;
+					if (v < NUM_WIN) used[(v + NUM_SEQ) / 32] |= (DWORD)1 << ((v + NUM_SEQ) % 32);
+				}
+			}
+			res = dir_next(dp, 0);
+		}
+		if (res == FR_NO_FILE) res = FR_OK;
+		if (res != FR_OK) return res;
+		for (i = 0; i < NUM_SEQ + NUM_WIN; i++) {	/* Take the first free candidate */
+			if (used[i / 32] & ((DWORD)1 << (i % 32))) continue;
+			gen_numname(dp->fn, sn, (i < NUM_SEQ) ? i + 1 : (hash + base + i - NUM_SEQ) & 0xFFFF);
+			return FR_OK;
+		}
+	}
+	return FR_DENIED;
+}
 #endif	/* FF_USE_LFN && !FF_FS_READONLY */
 
 
@@ -2321,109 +3058,477 @@ void create_xdir (
 	dirb[0 * SZDIRE + XDIR_Type] = 0x85;	/* 85 entry */
 	dirb[1 * SZDIRE + XDIR_Type] = 0xC0;	/* C0 entry */
 
-	/* Create C1 entries */
-	i = SZDIRE * 2;	/* Top of C1 entries */
-	nlen = nc1 = 0; wc = 1;
-	do {
-		dirb[i++] = 0xC1; dirb[i++] = 0;	/* Entry type C1 */
-		do {	/* Fill name field */
-			if (wc != 0 && (wc = lfn[nlen]) != 0) nlen++;	/* Get a character if exist */
-			st_word(dirb + i, wc); 		/* Store it */
-			i += 2;
-		} while (i % SZDIRE != 0);
-		nc1++;
-	} while (lfn[nlen]);	/* Fill next entry if any char follows */
+	/* Create C1 entries */
+	i = SZDIRE * 2;	/* Top of C1 entries */
+	nlen = nc1 = 0; wc = 1;
+	do {
+		dirb[i++] = 0xC1; dirb[i++] = 0;	/* Entry type C1 */
+		do {	/* Fill name field */
+			if (wc != 0 && (wc = lfn[nlen]) != 0) nlen++;	/* Get a character if exist */
+			st_word(dirb + i, wc); 		/* Store it */
+			i += 2;
+		} while (i % SZDIRE != 0);
+		nc1++;
+	} while (lfn[nlen]);	/* Fill next entry if any char follows */
+
+	dirb[XDIR_NumName] = nlen;		/* Set name length */
+	dirb[XDIR_NumSec] = 1 + nc1;	/* Set secondary count (C0 + C1s) */
+	st_word(dirb + XDIR_NameHash, xname_sum(lfn));	/* Set name hash */
+}
+
+#endif	/* !FF_FS_READONLY */
+#endif	/* FF_FS_EXFAT */
+
+
+
+#if FF_FS_MINIMIZE <= 1 || FF_FS_RPATH >= 2 || FF_USE_LABEL || FF_FS_EXFAT
+/*-----------------------------------------------------------------------*/
+/* Read an object from the directory                                     */
+/*-----------------------------------------------------------------------*/
+
+#define dir_read_file(dp) dir_read(dp, 0)
+#define dir_read_label(dp) dir_read(dp, 1)
+
+static
+FRESULT dir_read (
+	DIR* dp,		/* Pointer to the directory object */
+	int vol			/* Filtered by 0:file/directory or 1:volume label */
+)
+{
+	FRESULT res = FR_NO_FILE;
+	FATFS *fs = dp->obj.fs;
+	BYTE a, c;
+#if FF_USE_LFN
+	BYTE ord = 0xFF, sum = 0xFF;
+#endif
+
+	while (dp->sect) {
+		res = move_window(fs, dp->sect);
+		if (res != FR_OK) break;
+		c = dp->dir[DIR_Name];	/* Test for the entry type */
+		if (c == 0) {
+			res = FR_NO_FILE; break; /* Reached to end of the directory */
+		}
+#if FF_FS_EXFAT
+		if (fs->fs_type == FS_EXFAT) {	/* On the exFAT volume */
+			if (FF_USE_LABEL && vol) {
+				if (c == 0x83) break;	/* Volume label entry? */
+			} else {
+				if (c == 0x85) {		/* Start of the file entry block? */
+					dp->blk_ofs = dp->dptr;	/* Get location of the block */
+					res = load_xdir(dp);	/* Load the entry block */
+					if (res == FR_OK) {
+						dp->obj.attr = fs->dirbuf[XDIR_Attr] & AM_MASK;	/* Get attribute */
+					}
+					break;
+				}
+			}
+		} else
+#endif
+		{	/* On the FAT/FAT32 volume */
+			dp->obj.attr = a = dp->dir[DIR_Attr] & AM_MASK;	/* Get attribute */
+#if FF_USE_LFN		/* LFN configuration */
+			if (c == DDEM || c == '.' || (int)((a & ~AM_ARC) == AM_VOL) != vol) {	/* An entry without valid data */
+				ord = 0xFF;
+			} else {
+				if (a == AM_LFN) {			/* An LFN entry is found */
+					if (c & LLEF) {			/* Is it start of an LFN sequence? */
+						sum = dp->dir[LDIR_Chksum];
+						c &= (BYTE)~LLEF; ord = c;
+						dp->blk_ofs = dp->dptr;
+					}
+					/* Check LFN validity and capture it */
+					ord = (c == ord && sum == dp->dir[LDIR_Chksum] && pick_lfn(fs->lfnbuf, dp->dir)) ? ord - 1 : 0xFF;
+				} else {					/* An SFN entry is found */
+					if (ord != 0 || sum != sum_sfn(dp->dir)) {	/* Is there a valid LFN? */
+						dp->blk_ofs = 0xFFFFFFFF;			/* It has no LFN. */
+					}
+					break;
+				}
+			}
+#else		/* Non LFN configuration */
+			if (c != DDEM && c != '.' && a != AM_LFN && (int)((a & ~AM_ARC) == AM_VOL) == vol) {	/* Is it a valid entry? */
+				break;
+			}
+#endif
+		}
+		res = dir_next(dp, 0);		/* Next entry */
+		if (res != FR_OK) break;
+	}
+
+	if (res != FR_OK) dp->sect = 0;		/* Terminate the read operation on error or EOT */
+	return res;
+}
+
+#endif	/* FF_FS_MINIMIZE <= 1 || FF_USE_LABEL || FF_FS_RPATH >= 2 */
+
+
+
+#if FF_DIR_INDEX
+/*-----------------------------------------------------------------------*/
+/* Directory hash index                                                  */
+/*-----------------------------------------------------------------------*/
+
+typedef struct DIRIDX_ {
+	struct DIRIDX_* next;	/* Next (less recently used) index */
+	DWORD	dcl;			/* Directory start cluster (0:FAT/FAT16 root directory) */
+	UINT	nent;			/* Number of directory entries covered */
+	BYTE	key[1];			/* Hash of the object starting at each entry (0:none) */
+} DIRIDX;
+
+
+static
+DWORD dix_mix (		/* Hash contribution of a character at a position */
+	DWORD c,		/* Character */
+	UINT i			/* Position in the name */
+)
+{
+	c = (c ^ (DWORD)i << 16) * 0x9E3779B1;
+	return c ^ c >> 15;
+}
+
+
+static
+BYTE dix_fold (		/* 1..255: Index key of the hash */
+	DWORD h
+)
+{
+	h ^= h >> 16; h ^= h >> 8;
+	return (BYTE)h ? (BYTE)h : 1;
+}
+
+
+static
+BYTE dix_lfn (		/* Key of an LFN */
+	const WCHAR* lfn	/* Pointer to the name */
+)
+{
+	DWORD h = 0;
+	UINT i;
+
+
+	for (i = 0; lfn[i]; i++) h += dix_mix(up_lfn(lfn[i]), i);
+	return dix_fold(h);
+}
+
+
+static
+DWORD dix_lfn_ent (	/* Hash of the part of LFN in an LFN entry (summed up by entries) */
+	const BYTE* dir		/* Pointer to the LFN entry */
+)
+{
+	DWORD h = 0;
+	UINT i, s;
+	WCHAR wc;
+
+
+	i = ((dir[LDIR_Ord] & 0x3F) - 1) * 13;	/* Offset in the name */
+	for (s = 0; s < 13; s++, i++) {
+		wc = ld_word(dir + LfnOfs[s]);
+		if (wc == 0) break;				/* End of the name */
+		h += dix_mix(up_lfn(wc), i);
+	}
+	return h;
+}
+
+
+static
+BYTE dix_sfn (		/* Key of an SFN */
+	const BYTE* sfn		/* Pointer to the SFN in directory form */
+)
+{
+	DWORD h = 0;
+	UINT i;
+
+
+	for (i = 0; i < 11; i++) h += dix_mix(sfn[i], i + 0x100);
+	return dix_fold(h);
+}
+
+
+static
+DWORD dix_clust (	/* Index identifier of the directory */
+	DIR* dp
+)
+{
+	FATFS *fs = dp->obj.fs;
+
+
+	return (dp->obj.sclust == 0 && fs->fs_type == FS_FAT32) ? fs->dirbase : dp->obj.sclust;
+}
+
+
+static
+DIRIDX* find_dix (	/* NULL: the directory is not indexed */
+	FATFS* fs,		/* Filesystem object */
+	DWORD dcl,		/* Directory identifier */
+	int mru			/* Move it to the top of the list */
+)
+{
+	DIRIDX *ix, **pp;
+
+
+	for (pp = (DIRIDX**)&fs->dix; (ix = *pp) != 0; pp = &ix->next) {
+		if (ix->dcl == dcl) {
+			if (mru) {
+				*pp = ix->next;
+				ix->next = fs->dix;
+				fs->dix = ix;
+			}
+			break;
+		}
+	}
+	return ix;
+}
+
+
+static
+void drop_dix (
+	FATFS* fs,		/* Filesystem object */
+	DWORD dcl		/* Directory identifier, 0xFFFFFFFF:least recently used one */
+)
+{
+	DIRIDX *ix, **pp, **pl = 0;
+
+
+	for (pp = (DIRIDX**)&fs->dix; (ix = *pp) != 0; pp = &ix->next) {
+		if (ix->dcl == dcl) break;
+		pl = pp;
+	}
+	if (!ix && dcl == 0xFFFFFFFF && pl) {	/* Pick the last one */
+		pp = pl; ix = *pp;
+	}
+	if (ix) {
+		*pp = ix->next;
+		fs->dix_heap -= sizeof (DIRIDX) + ix->nent;
+		ff_memfree(ix);
+	}
+}
+
+
+static
+void free_dix (
+	FATFS* fs		/* Filesystem object */
+)
+{
+	while (fs->dix) drop_dix(fs, 0xFFFFFFFF);
+}
+
+
+static
+DIRIDX* load_dix (	/* NULL: the directory cannot be indexed */
+	DIR* dp			/* Directory object (position is changed) */
+)
+{
+	FATFS *fs = dp->obj.fs;
+	DIRIDX *ix;
+	DWORD dcl, clst, h = 0;
+	UINT nent, i, top = 0, sz;
+	BYTE a, c, ord = 0xFF, sum = 0xFF;
+
+
+	dcl = dix_clust(dp);
+	if (dcl == 0) {				/* FAT/FAT16 root directory */
+		nent = fs->n_rootdir;
+	} else {					/* Count the entries in the cluster chain */
+		nent = 0; clst = dcl;
+		do {
+			nent += (UINT)fs->csize * SS(fs) / SZDIRE;
+			if (nent > FF_DIR_INDEX) return 0;
+			clst = get_fat(&dp->obj, clst);
+			if (clst < 2 || clst == 0xFFFFFFFF) return 0;
+		} while (clst < fs->n_fatent);
+	}
+	sz = sizeof (DIRIDX) + nent;
+	if (sz > FF_DIR_INDEX) return 0;	/* Over the heap budget? */
+	while (fs->dix && fs->dix_heap + sz > FF_DIR_INDEX) drop_dix(fs, 0xFFFFFFFF);	/* Discard least recently used ones */
+	ix = ff_memalloc(sz);
+	if (!ix) return 0;
+	ix->dcl = dcl; ix->nent = nent;
+	mem_set(ix->key, 0, nent);
+
+	if (dir_sdi(dp, 0) == FR_OK) {	/* Scan the directory in the same way as dir_find() */
+		for (;;) {
+			if (move_window(fs, dp->sect) != FR_OK) break;
+			c = dp->dir[DIR_Name];
+			if (c == 0) { dp->sect = 0; break; }	/* End of table */
+			i = (UINT)(dp->dptr / SZDIRE);
+			a = dp->dir[DIR_Attr] & AM_MASK;
+			if (i >= nent) break;
+			if (c == DDEM || ((a & AM_VOL) && a != AM_LFN)) {	/* An entry without valid data */
+				ord = 0xFF;
+			} else if (a == AM_LFN) {	/* An LFN entry */
+				if (c & LLEF) {			/* Start of LFN sequence */
+					sum = dp->dir[LDIR_Chksum];
+					c &= (BYTE)~LLEF; ord = c;
+					top = i; h = 0;
+				}
+				if (c == ord && sum == dp->dir[LDIR_Chksum] && ld_word(dp->dir + LDIR_FstClusLO) == 0) {
+					h += dix_lfn_ent(dp->dir);
+					ord--;
+				} else {
+					ord = 0xFF;
+				}
+			} else {					/* An SFN entry: the object is keyed by its LFN if valid */
+				if (ord == 0 && sum == sum_sfn(dp->dir)) {
+					ix->key[top] = dix_fold(h);
+				} else {
+					ix->key[i] = dix_sfn(dp->dir);
+				}
+				ord = 0xFF;
+			}
+			if (dir_next(dp, 0) != FR_OK) break;	/* End of directory (sect is cleared) or error */
+		}
+	}
+	if (dp->sect != 0) {	/* Aborted by error */
+		ff_memfree(ix);
+		return 0;
+	}
+	ix->next = fs->dix;
+	fs->dix = ix;
+	fs->dix_heap += sz;
+	return ix;
+}
+
+
+#if !FF_FS_READONLY
+static
+void dix_set (
+	DIR* dp,		/* Directory object */
+	DWORD ofs,		/* Offset of the top entry of the object */
+	UINT n,			/* Number of entries of the object */
+	BYTE key		/* New key of the object (0:removed) */
+)
+{
+	FATFS *fs = dp->obj.fs;
+	DIRIDX *ix;
+
+
+	if (FF_FS_EXFAT && fs->fs_type == FS_EXFAT) return;
+	ix = find_dix(fs, dix_clust(dp), 0);
+	if (!ix) return;
+	if (ofs / SZDIRE + n > ix->nent) {	/* Directory has been stretched */
+		drop_dix(fs, ix->dcl);
+		return;
+	}
+	ix->key[ofs / SZDIRE] = key;
+}
+#endif
+#endif	/* FF_DIR_INDEX */
+
+
+
+#if FF_PATH_CACHE || FF_NEG_CACHE
+/*-----------------------------------------------------------------------*/
+/* Path lookup cache                                                     */
+/*-----------------------------------------------------------------------*/
+
+typedef struct {
+	DWORD	dcl;			/* Start cluster of the containing directory (as DIR.obj.sclust) */
+	DWORD	ofs;			/* Offset of the top entry of the object in the directory */
+	DWORD	tick;			/* Last use */
+	BYTE	res;			/* Result of the lookup (negative cache) */
+	BYTE	len;			/* Length of the path (0:unused entry) */
+	char	path[FF_PATH_CACHE_LEN];	/* Path without heading separator */
+} PCENT;
+
+
+static
+void free_pcache (
+	FATFS* fs		/* Filesystem object */
+)
+{
+#if FF_PATH_CACHE
+	if (fs->pcache) {
+		ff_memfree(fs->pcache);
+		fs->pcache = 0;
+	}
+#endif
+#if FF_NEG_CACHE
+	if (fs->ncache) {
+		ff_memfree(fs->ncache);
+		fs->ncache = 0;
+	}
+#endif
+}
+#endif
+
+
+#if FF_NEG_CACHE
+static
+void nc_flush (
+	FATFS* fs		/* Filesystem object */
+)
+{
+	PCENT *nc = fs->ncache;
+	UINT i;
+
 
-	dirb[XDIR_NumName] = nlen;		/* Set name length */
-	dirb[XDIR_NumSec] = 1 + nc1;	/* Set secondary count (C0 + C1s) */
-	st_word(dirb + XDIR_NameHash, xname_sum(lfn));	/* Set name hash */
+	if (!nc) return;
+	for (i = 0; i < FF_NEG_CACHE; i++) nc[i].len = 0;
 }
+#endif
 
-#endif	/* !FF_FS_READONLY */
-#endif	/* FF_FS_EXFAT */
 
+#if FF_PATH_CACHE
+static
+void pc_drop (
+	FATFS* fs,		/* Filesystem object */
+	DWORD dcl,		/* Containing directory of the entries to discard, 0xFFFFFFFF:all */
+	DWORD ofs		/* Offset of the object to discard, 0xFFFFFFFF:all in the directory */
+)
+{
+	PCENT *pc = fs->pcache;
+	UINT i;
 
 
-#if FF_FS_MINIMIZE <= 1 || FF_FS_RPATH >= 2 || FF_USE_LABEL || FF_FS_EXFAT
-/*-----------------------------------------------------------------------*/
-/* Read an object from the directory                                     */
-/*-----------------------------------------------------------------------*/
+	if (!pc) return;
+	for (i = 0; i < FF_PATH_CACHE; i++) {
+		if (dcl == 0xFFFFFFFF || (pc[i].dcl == dcl && (ofs == 0xFFFFFFFF || pc[i].ofs == ofs))) pc[i].len = 0;
+	}
+}
+#endif	/* FF_PATH_CACHE */
+
 
-#define dir_read_file(dp) dir_read(dp, 0)
-#define dir_read_label(dp) dir_read(dp, 1)
 
+#if FF_DIR_INDEX || FF_PATH_CACHE
 static
-FRESULT dir_read (
-	DIR* dp,		/* Pointer to the directory object */
-	int vol			/* Filtered by 0:file/directory or 1:volume label */
+FRESULT dir_find_at (	/* FR_OK:matched, FR_NO_FILE:not matched, others:error */
+	DIR* dp,			/* Pointer to the directory object with the file name */
+	DWORD ofs			/* Offset of the top entry of the candidate object */
 )
 {
-	FRESULT res = FR_NO_FILE;
+	FRESULT res;
 	FATFS *fs = dp->obj.fs;
-	BYTE a, c;
-#if FF_USE_LFN
-	BYTE ord = 0xFF, sum = 0xFF;
-#endif
+	BYTE a, c, ord = 0xFF, sum = 0xFF;
 
-	while (dp->sect) {
+
+	res = dir_sdi(dp, ofs);
+	dp->blk_ofs = 0xFFFFFFFF;
+	while (res == FR_OK) {
 		res = move_window(fs, dp->sect);
 		if (res != FR_OK) break;
-		c = dp->dir[DIR_Name];	/* Test for the entry type */
-		if (c == 0) {
-			res = FR_NO_FILE; break; /* Reached to end of the directory */
-		}
-#if FF_FS_EXFAT
-		if (fs->fs_type == FS_EXFAT) {	/* On the exFAT volume */
-			if (FF_USE_LABEL && vol) {
-				if (c == 0x83) break;	/* Volume label entry? */
-			} else {
-				if (c == 0x85) {		/* Start of the file entry block? */
-					dp->blk_ofs = dp->dptr;	/* Get location of the block */
-					res = load_xdir(dp);	/* Load the entry block */
-					if (res == FR_OK) {
-						dp->obj.attr = fs->dirbuf[XDIR_Attr] & AM_MASK;	/* Get attribute */
-					}
-					break;
-				}
-			}
-		} else
-#endif
-		{	/* On the FAT/FAT32 volume */
-			dp->obj.attr = a = dp->dir[DIR_Attr] & AM_MASK;	/* Get attribute */
-#if FF_USE_LFN		/* LFN configuration */
-			if (c == DDEM || c == '.' || (int)((a & ~AM_ARC) == AM_VOL) != vol) {	/* An entry without valid data */
-				ord = 0xFF;
-			} else {
-				if (a == AM_LFN) {			/* An LFN entry is found */
-					if (c & LLEF) {			/* Is it start of an LFN sequence? */
-						sum = dp->dir[LDIR_Chksum];
-						c &= (BYTE)~LLEF; ord = c;
-						dp->blk_ofs = dp->dptr;
-					}
-					/* Check LFN validity and capture it */
-					ord = (c == ord && sum == dp->dir[LDIR_Chksum] && pick_lfn(fs->lfnbuf, dp->dir)) ? ord - 1 : 0xFF;
-				} else {					/* An SFN entry is found */
-					if (ord != 0 || sum != sum_sfn(dp->dir)) {	/* Is there a valid LFN? */
-						dp->blk_ofs = 0xFFFFFFFF;			/* It has no LFN. */
-					}
-					break;
-				}
-			}
-#else		/* Non LFN configuration */
-			if (c != DDEM && c != '.' && a != AM_LFN && (int)((a & ~AM_ARC) == AM_VOL) == vol) {	/* Is it a valid entry? */
-				break;
+		c = dp->dir[DIR_Name];
+		if (c == 0) return FR_NO_FILE;	/* Reached to end of table */
+		dp->obj.attr = a = dp->dir[DIR_Attr] & AM_MASK;
+		if (c == DDEM || ((a & AM_VOL) && a != AM_LFN)) return FR_NO_FILE;	/* Not an object */
+		if (a == AM_LFN) {			/* An LFN entry is found */
+			if (c & LLEF) {			/* Is it start of LFN sequence? */
+				sum = dp->dir[LDIR_Chksum];
+				c &= (BYTE)~LLEF; ord = c;	/* LFN start order */
+				dp->blk_ofs = dp->dptr;	/* Start offset of LFN */
 			}
-#endif
+			ord = (c == ord && sum == dp->dir[LDIR_Chksum] && cmp_lfn(fs->lfnbuf, dp->dir)) ? ord - 1 : 0xFF;
+		} else {					/* An SFN entry ends the object */
+			if (ord == 0 && sum == sum_sfn(dp->dir)) return FR_OK;	/* LFN matched? */
+			if (!(dp->fn[NSFLAG] & NS_LOSS) && !mem_cmp(dp->dir, dp->fn, 11)) return FR_OK;	/* SFN matched? */
+			return FR_NO_FILE;
 		}
-		res = dir_next(dp, 0);		/* Next entry */
-		if (res != FR_OK) break;
+		res = dir_next(dp, 0);	/* Next entry */
 	}
-
-	if (res != FR_OK) dp->sect = 0;		/* Terminate the read operation on error or EOT */
 	return res;
 }
-
-#endif	/* FF_FS_MINIMIZE <= 1 || FF_USE_LABEL || FF_FS_RPATH >= 2 */
+#endif	/* FF_DIR_INDEX || FF_PATH_CACHE */
 
 
 
@@ -2442,6 +3547,31 @@ FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 #if FF_USE_LFN
 	BYTE a, ord, sum;
 #endif
+#if FF_DIR_INDEX
+	DIRIDX *ix;
+	UINT i;
+	BYTE kl, ks;
+
+	for (i = 0; i < 11 && dp->fn[i] != '~'; i++) ;
+	if ((!FF_FS_EXFAT || fs->fs_type != FS_EXFAT)
+		&& !(dp->fn[NSFLAG] & NS_NOLFN)
+		&& ((dp->fn[NSFLAG] & NS_LOSS) || i == 11))	/* Numbered SFN may be an alias of an LFN object */
+	{
+		ix = find_dix(fs, dix_clust(dp), 1);
+		if (!ix) ix = load_dix(dp);		/* Index the directory at first lookup */
+		if (ix) {
+			kl = dix_lfn(fs->lfnbuf);	/* Key by LFN */
+			ks = (dp->fn[NSFLAG] & NS_LOSS) ? 0 : dix_sfn(dp->fn);	/* Key by SFN if valid */
+			for (i = 0; i < ix->nent; i++) {	/* Test the objects with matching key */
+				if (ix->key[i] == kl || (ix->key[i] == ks && ks)) {
+					res = dir_find_at(dp, (DWORD)i * SZDIRE);
+					if (res != FR_NO_FILE) return res;
+				}
+			}
+			return FR_NO_FILE;
+		}
+	}
+#endif
 
 	res = dir_sdi(dp, 0);			/* Rewind directory object */
 	if (res != FR_OK) return res;
@@ -2458,7 +3588,7 @@ FRESULT dir_find (	/* FR_OK(0):succeeded, !=0:error */
 			if (ld_word(fs->dirbuf + XDIR_NameHash) != hash) continue;	/* Skip comparison if hash mismatched */
 			for (nc = fs->dirbuf[XDIR_NumName], di = SZDIRE * 2, ni = 0; nc; nc--, di += 2, ni++) {	/* Compare the name */
 				if ((di % SZDIRE) == 0) di += 2;
-				if (ff_wtoupper(ld_word(fs->dirbuf + di)) != ff_wtoupper(fs->lfnbuf[ni])) break;
+				if (up_lfn(ld_word(fs->dirbuf + di)) != up_lfn(fs->lfnbuf[ni])) break;
 			}
 			if (nc == 0 && !fs->lfnbuf[ni]) break;	/* Name matched? */
 		}
@@ -2521,12 +3651,15 @@ FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too many S
 	FRESULT res;
 	FATFS *fs = dp->obj.fs;
 #if FF_USE_LFN		/* LFN configuration */
-	UINT n, nlen, nent;
+	UINT nlen, nent;
 	BYTE sn[12], sum;
 
 
 	if (dp->fn[NSFLAG] & (NS_DOT | NS_NONAME)) return FR_INVALID_NAME;	/* Check name validity */
 	for (nlen = 0; fs->lfnbuf[nlen]; nlen++) ;	/* Get lfn length */
+#if FF_NEG_CACHE
+	nc_flush(fs);		/* A missing path may come into existence */
+#endif
 
 #if FF_FS_EXFAT
 	if (fs->fs_type == FS_EXFAT) {	/* On the exFAT volume */
@@ -2562,14 +3695,8 @@ FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too many S
 	/* On the FAT/FAT32 volume */
 	mem_cpy(sn, dp->fn, 12);
 	if (sn[NSFLAG] & NS_LOSS) {			/* When LFN is out of 8.3 format, generate a numbered name */
-		dp->fn[NSFLAG] = NS_NOLFN;		/* Find only SFN */
-		for (n = 1; n < 100; n++) {
-			gen_numname(dp->fn, sn, fs->lfnbuf, n);	/* Generate a numbered name */
-			res = dir_find(dp);				/* Check if the name collides with existing SFN */
-			if (res != FR_OK) break;
-		}
-		if (n == 100) return FR_DENIED;		/* Abort if too many collisions */
-		if (res != FR_NO_FILE) return res;	/* Abort if the result is other than 'not collided' */
+		res = dir_numname(dp, sn);		/* Find a free numbered name in a directory scan */
+		if (res != FR_OK) return res;
 		dp->fn[NSFLAG] = sn[NSFLAG];
 	}
 
@@ -2607,6 +3734,12 @@ FRESULT dir_register (	/* FR_OK:succeeded, FR_DENIED:no free entry or too many S
 			fs->wflag = 1;
 		}
 	}
+#if FF_DIR_INDEX
+	if (res == FR_OK) {		/* Register the object to the directory index */
+		UINT n = (sn[NSFLAG] & NS_LFN) ? (nlen + 12) / 13 : 0;	/* Number of LFN entries */
+		dix_set(dp, dp->dptr - n * SZDIRE, n + 1, n ? dix_lfn(fs->lfnbuf) : dix_sfn(dp->fn));
+	}
+#endif
 
 	return res;
 }
@@ -2630,6 +3763,12 @@ FRESULT dir_remove (	/* FR_OK:Succeeded, FR_DISK_ERR:A disk error */
 #if FF_USE_LFN		/* LFN configuration */
 	DWORD last = dp->dptr;
 
+#if FF_DIR_INDEX
+	dix_set(dp, (dp->blk_ofs == 0xFFFFFFFF) ? dp->dptr : dp->blk_ofs, 1, 0);	/* Remove the object from the directory index */
+#endif
+#if FF_PATH_CACHE
+	pc_drop(fs, dp->obj.sclust, (dp->blk_ofs == 0xFFFFFFFF) ? dp->dptr : dp->blk_ofs);	/* Discard cached paths to the object */
+#endif
 	res = (dp->blk_ofs == 0xFFFFFFFF) ? FR_OK : dir_sdi(dp, dp->blk_ofs);	/* Goto top of the entry block if LFN is exist */
 	if (res == FR_OK) {
 		do {
@@ -3050,6 +4189,126 @@ FRESULT create_name (	/* FR_OK: successful, FR_INVALID_NAME: could not create */
 /* Follow a file path                                                    */
 /*-----------------------------------------------------------------------*/
 
+#if FF_PATH_CACHE || FF_NEG_CACHE
+static
+PCENT* pc_match (	/* Matched entry, NULL:not cached */
+	PCENT* pc,			/* Cache entries (NULL:not allocated) */
+	UINT n,				/* Number of entries */
+	const TCHAR* path,	/* Path without heading separator */
+	UINT len			/* Length of the path */
+)
+{
+	UINT i;
+
+
+	if (!pc || len >= FF_PATH_CACHE_LEN) return 0;
+	for (i = 0; i < n; i++) {
+		if (pc[i].len == len && !mem_cmp(pc[i].path, path, len)) return &pc[i];
+	}
+	return 0;
+}
+
+
+static
+FRESULT pc_name (	/* Set the last segment of the path as the object name */
+	DIR* dp,			/* Directory object to set the name */
+	const TCHAR* path,	/* Path without heading separator */
+	UINT len			/* Length of the path */
+)
+{
+	const TCHAR *seg = path + len;
+
+
+	while (seg > path && (seg[-1] == '/' || seg[-1] == '\\')) seg--;	/* Find the last segment */
+	while (seg > path && seg[-1] != '/' && seg[-1] != '\\') seg--;
+	return create_name(dp, &seg);
+}
+
+
+static
+void pc_store (
+	FATFS* fs,			/* Filesystem object */
+	void** tbl,			/* Cache entries (allocated at first store) */
+	UINT n,				/* Number of entries */
+	const TCHAR* path,	/* Path without heading separator */
+	UINT len,			/* Length of the path */
+	DWORD dcl,			/* Containing directory */
+	DWORD ofs,			/* Offset of the object in the directory */
+	FRESULT res			/* Result of the lookup */
+)
+{
+	PCENT *pc = *tbl;
+	UINT i, v;
+
+
+	if (len >= FF_PATH_CACHE_LEN) return;
+	if (!pc) {
+		pc = ff_memalloc(n * sizeof (PCENT));
+		if (!pc) return;
+		for (i = 0; i < n; i++) pc[i].len = 0;
+		*tbl = pc;
+	}
+	for (v = i = 0; i < n; i++) {	/* Pick an unused or the least recently used entry */
+		if (pc[i].len == 0) { v = i; break; }
+		if (pc[i].tick < pc[v].tick) v = i;
+	}
+	pc[v].dcl = dcl;
+	pc[v].ofs = ofs;
+	pc[v].res = (BYTE)res;
+	pc[v].tick = ++fs->pc_tick;
+	pc[v].len = (BYTE)len;
+	mem_cpy(pc[v].path, path, len);
+}
+
+
+static
+FRESULT pc_find (	/* FR_OK:found, FR_NO_FILE/FR_NO_PATH:known to be missing, FR_INT_ERR:not cached, others:error */
+	DIR* dp,			/* Directory object to return the found object */
+	const TCHAR* path,	/* Path without heading separator */
+	UINT len			/* Length of the path */
+)
+{
+	FRESULT res;
+	FATFS *fs = dp->obj.fs;
+	PCENT *pc;
+
+
+#if FF_PATH_CACHE
+	pc = pc_match(fs->pcache, FF_PATH_CACHE, path, len);
+	if (pc) {
+		res = pc_name(dp, path, len);	/* Set the name to compare */
+		if (res == FR_OK) {
+			dp->obj.sclust = pc->dcl;
+			res = dir_find_at(dp, pc->ofs);	/* Check if the object is still there */
+		}
+		if (res == FR_OK) {
+			pc->tick = ++fs->pc_tick;
+			fs->pc_hit++;
+			return FR_OK;
+		}
+		pc->len = 0;		/* Discard the stale entry */
+		if (res != FR_NO_FILE && res != FR_INVALID_NAME) return res;
+	}
+	fs->pc_miss++;
+#endif
+#if FF_NEG_CACHE
+	pc = pc_match(fs->ncache, FF_NEG_CACHE, path, len);
+	if (pc) {
+		res = (FRESULT)pc->res;
+		if (res == FR_NO_FILE) {	/* Set the directory and name for object creation */
+			if (pc_name(dp, path, len) != FR_OK) return FR_INT_ERR;
+			dp->obj.sclust = pc->dcl;
+		}
+		pc->tick = ++fs->pc_tick;
+		fs->nc_hit++;
+		return res;
+	}
+#endif
+	return FR_INT_ERR;
+}
+#endif	/* FF_PATH_CACHE || FF_NEG_CACHE */
+
+
 static
 FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 	DIR* dp,			/* Directory object to return last directory and found object */
@@ -3059,6 +4318,11 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 	FRESULT res;
 	BYTE ns;
 	FATFS *fs = dp->obj.fs;
+#if FF_PATH_CACHE || FF_NEG_CACHE
+	const TCHAR *top;
+	UINT len;
+	int pc_ok;
+#endif
 
 
 #if FF_FS_RPATH != 0
@@ -3092,6 +4356,18 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 		res = dir_sdi(dp, 0);
 
 	} else {								/* Follow path */
+#if FF_PATH_CACHE || FF_NEG_CACHE
+		/* Only absolute paths without dot segments map to an object for sure */
+		pc_ok = !FF_FS_RPATH || dp->obj.sclust == 0;
+		if (FF_FS_EXFAT && fs->fs_type == FS_EXFAT) pc_ok = 0;
+		for (len = 0; path[len]; len++) ;
+		if (pc_ok) {
+			res = pc_find(dp, path, len);
+			if (res != FR_INT_ERR) return res;
+			dp->obj.sclust = 0;
+		}
+		top = path;
+#endif
 		for (;;) {
 			res = create_name(dp, &path);	/* Get a segment name of the path */
 			if (res != FR_OK) break;
@@ -3107,11 +4383,31 @@ FRESULT follow_path (	/* FR_OK(0): successful, !=0: error code */
 						if (!(ns & NS_LAST)) res = FR_NO_PATH;	/* Adjust error code if not last segment */
 					}
 				}
+#if FF_NEG_CACHE
+				if ((res == FR_NO_FILE || res == FR_NO_PATH) && pc_ok && !(ns & NS_DOT)) {	/* Remember the missing path */
+					pc_store(fs, &fs->ncache, FF_NEG_CACHE, top, len, dp->obj.sclust, 0, res);
+					fs->nc_miss++;
+				}
+#endif
 				break;
 			}
+#if FF_PATH_CACHE || FF_NEG_CACHE
+			if (ns & NS_DOT) pc_ok = 0;
+#endif
+#if FF_PATH_CACHE
+			if ((ns & NS_LAST) && pc_ok) {		/* Cache the location of the object */
+				pc_store(fs, &fs->pcache, FF_PATH_CACHE, top, len, dp->obj.sclust, (dp->blk_ofs == 0xFFFFFFFF) ? dp->dptr : dp->blk_ofs, FR_OK);
+			}
+#endif
 			if (ns & NS_LAST) break;			/* Last segment matched. Function completed. */
 			/* Get into the sub-directory */
 			if (!(dp->obj.attr & AM_DIR)) {		/* It is not a sub-directory and cannot follow */
+#if FF_NEG_CACHE
+				if (pc_ok) {
+					pc_store(fs, &fs->ncache, FF_NEG_CACHE, top, len, 0, 0, FR_NO_PATH);
+					fs->nc_miss++;
+				}
+#endif
 				res = FR_NO_PATH; break;
 			}
 #if FF_FS_EXFAT
@@ -3271,6 +4567,21 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 	/* Following code attempts to mount the volume. (analyze BPB and initialize the filesystem object) */
 
 	fs->fs_type = 0;					/* Clear the filesystem object */
+#if FF_FAT_MIRROR
+	free_mirror(fs);					/* Discard the stale FAT mirror */
+#endif
+#if FF_FAT_CACHE
+	free_fatcache(fs);					/* Discard the stale FAT cache */
+#endif
+#if FF_FREE_BITMAP
+	free_fbmp(fs);						/* Discard the stale free cluster bitmap */
+#endif
+#if FF_DIR_INDEX
+	free_dix(fs);						/* Discard the stale directory indexes */
+#endif
+#if FF_PATH_CACHE || FF_NEG_CACHE
+	free_pcache(fs);					/* Discard the stale path lookup caches */
+#endif
 	fs->pdrv = LD2PD(vol);				/* Bind the logical drive and a physical drive */
 	stat = disk_initialize(fs->pdrv);	/* Initialize the physical drive */
 	if (stat & STA_NOINIT) { 			/* Check if the initialization succeeded */
@@ -3408,9 +4719,16 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 		fs->last_clst = fs->free_clst = 0xFFFFFFFF;		/* Initialize cluster allocation information */
 		fs->fsi_flag = 0x80;
 #if (FF_FS_NOFSINFO & 3) != 3
+#if !FF_ALLOC_SUMMARY
 		if (fmt == FS_FAT32				/* Allow to update FSInfo only if BPB_FSInfo32 == 1 */
 			&& ld_word(fs->win + BPB_FSInfo32) == 1
 			&& move_window(fs, bsect + 1) == FR_OK)
+#else
+		if ((fmt == FS_FAT32			/* Allow to update FSInfo only if BPB_FSInfo32 == 1 */
+			? ld_word(fs->win + BPB_FSInfo32) == 1
+			: nrsv >= 2)				/* FAT/FAT16: the summary follows the VBR if reserved */
+			&& move_window(fs, bsect + 1) == FR_OK)
+#endif
 		{
 			fs->fsi_flag = 0;
 			if (ld_word(fs->win + BS_55AA) == 0xAA55	/* Load FSInfo data if available */
@@ -3422,6 +4740,14 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 #endif
 #if (FF_FS_NOFSINFO & 2) == 0
 				fs->last_clst = ld_dword(fs->win + FSI_Nxt_Free);
+#endif
+#if FF_ALLOC_SUMMARY
+				/* Trust the record only if it is consistent with the volume */
+				if (fs->free_clst > fs->n_fatent - 2) fs->free_clst = 0xFFFFFFFF;
+				if (fs->last_clst >= fs->n_fatent) fs->last_clst = 0xFFFFFFFF;
+				if (ld_dword(fs->win + FSI_Free_Count) != 0xFFFFFFFF) fs->fsi_flag = 2;	/* To be invalidated at the first FAT change */
+			} else if (fmt != FS_FAT32) {
+				fs->fsi_flag = 0x80;	/* Reserved sector is not a summary record, leave it alone */
 #endif
 			}
 		}
@@ -3431,6 +4757,12 @@ FRESULT find_volume (	/* FR_OK(0): successful, !=0: any error occurred */
 
 	fs->fs_type = fmt;		/* FAT sub-type */
 	fs->id = ++Fsid;		/* Volume mount ID */
+#if FF_FAT_MIRROR
+	load_mirror(fs);		/* Mirror the FAT if it fits in the heap budget */
+#endif
+#if FF_FAT_CACHE
+	init_fatcache(fs);		/* Cache FAT sectors apart from win[] */
+#endif
 #if FF_USE_LFN == 1
 	fs->lfnbuf = LfnBuf;	/* Static LFN working buffer */
 #if FF_FS_EXFAT
@@ -3521,12 +4853,57 @@ FRESULT f_mount (
 #endif
 #if FF_FS_REENTRANT						/* Discard sync object of the current volume */
 		if (!ff_del_syncobj(cfs->sobj)) return FR_INT_ERR;
+#endif
+#if FF_FAT_MIRROR
+#if !FF_FS_READONLY
+		if (cfs->fs_type) sync_mirror(cfs);	/* Write back the FAT mirror of the old fs object */
+#endif
+		free_mirror(cfs);
+#endif
+#if FF_FAT_CACHE
+#if !FF_FS_READONLY
+		if (cfs->fs_type) sync_fatcache(cfs);	/* Write back the FAT cache of the old fs object */
+#endif
+		free_fatcache(cfs);
+#endif
+#if FF_FREE_BITMAP
+		free_fbmp(cfs);
+#endif
+#if FF_DIR_INDEX
+		free_dix(cfs);
+#endif
+#if FF_PATH_CACHE || FF_NEG_CACHE
+		free_pcache(cfs);
 #endif
 		cfs->fs_type = 0;				/* Clear old fs object */
 	}
 
 	if (fs) {
 		fs->fs_type = 0;				/* Clear new fs object */
+#if FF_FAT_MIRROR
+		fs->fatmir = 0;					/* New fs object has no FAT mirror yet */
+#endif
+#if FF_FAT_CACHE
+		fs->fcbuf = 0;					/* New fs object has no FAT cache yet */
+#endif
+#if FF_FREE_BITMAP
+		fs->fbmp = 0;					/* New fs object has no free cluster bitmap yet */
+#endif
+#if FF_DIR_INDEX
+		fs->dix = 0;					/* New fs object has no directory index yet */
+		fs->dix_heap = 0;
+#endif
+#if FF_PATH_CACHE || FF_NEG_CACHE
+		fs->pc_tick = 0;
+#endif
+#if FF_PATH_CACHE
+		fs->pcache = 0;					/* New fs object has no path lookup cache yet */
+		fs->pc_hit = fs->pc_miss = 0;
+#endif
+#if FF_NEG_CACHE
+		fs->ncache = 0;					/* New fs object has no negative lookup cache yet */
+		fs->nc_hit = fs->nc_miss = 0;
+#endif
 #if FF_FS_REENTRANT						/* Create sync object for the new volume */
 		if (!ff_cre_syncobj((BYTE)vol, &fs->sobj)) return FR_INT_ERR;
 #endif
@@ -3691,6 +5068,10 @@ FRESULT f_open (
 			fp->obj.id = fs->id;
 			fp->flag = mode;		/* Set file access mode */
 			fp->err = 0;			/* Clear error flag */
+#if FF_EXTENT_ALLOC && !FF_FS_READONLY
+			fp->ext_len = 0;		/* No extent allocated yet */
+			fp->ext_rsv = 0;
+#endif
 			fp->sect = 0;			/* Invalidate current data sector */
 			fp->fptr = 0;			/* Set file pointer top of the file */
 #if !FF_FS_READONLY
@@ -3868,7 +5249,11 @@ FRESULT f_write (
 				if (fp->fptr == 0) {		/* On the top of the file? */
 					clst = fp->obj.sclust;	/* Follow from the origin */
 					if (clst == 0) {		/* If no cluster is allocated, */
+#if !FF_EXTENT_ALLOC
 						clst = create_chain(&fp->obj, 0);	/* create a new cluster chain */
+#else
+						clst = extent_chain(fp, 0, btw);	/* create a new cluster chain */
+#endif
 					}
 				} else {					/* On the middle or end of the file */
 #if FF_USE_FASTSEEK
@@ -3877,7 +5262,11 @@ FRESULT f_write (
 					} else
 #endif
 					{
+#if !FF_EXTENT_ALLOC
 						clst = create_chain(&fp->obj, fp->clust);	/* Follow or stretch cluster chain on the FAT */
+#else
+						clst = extent_chain(fp, fp->clust, btw);	/* Follow or stretch cluster chain on the FAT */
+#endif
 					}
 				}
 				if (clst == 0) break;		/* Could not allocate a new cluster (disk full) */
@@ -3975,6 +5364,13 @@ FRESULT f_sync (
 				if (disk_write(fs->pdrv, fp->buf, fp->sect, 1) != RES_OK) LEAVE_FF(fs, FR_DISK_ERR);
 				fp->flag &= (BYTE)~FA_DIRTY;
 			}
+#endif
+#if FF_EXTENT_ALLOC
+			if (fp->ext_len && !fp->ext_rsv) {	/* The chain on the disk must not go beyond the file size */
+				res = trim_extent(fp);		/* Release unused part of the last extent */
+				if (res != FR_OK) LEAVE_FF(fs, res);
+				fp->ext_len = 0;
+			}
 #endif
 			/* Update the directory entry */
 			tm = GET_FATTIME();				/* Modified time */
@@ -4014,6 +5410,11 @@ FRESULT f_sync (
 				if (res == FR_OK) {
 					dir = fp->dir_ptr;
 					dir[DIR_Attr] |= AM_ARC;						/* Set archive attribute to indicate that the file has been changed */
+#if FF_EXTENT_ALLOC
+					if (fp->ext_rsv && fp->obj.objsize == 0) {
+						st_clust(fp->obj.fs, dir, 0);		/* Reservation alone is not recorded until close */
+					} else
+#endif
 					st_clust(fp->obj.fs, dir, fp->obj.sclust);		/* Update file allocation information  */
 					st_dword(dir + DIR_FileSize, (DWORD)fp->obj.objsize);	/* Update file size */
 					st_dword(dir + DIR_ModTime, tm);				/* Update modified time */
@@ -4046,6 +5447,12 @@ FRESULT f_close (
 	FATFS *fs;
 
 #if !FF_FS_READONLY
+#if FF_EXTENT_ALLOC
+	if (fp->ext_rsv) {		/* Let f_sync() release the unused part of the reservation */
+		fp->ext_rsv = 0;
+		fp->flag |= FA_MODIFIED;
+	}
+#endif
 	res = f_sync(fp);					/* Flush cached data */
 	if (res == FR_OK)
 #endif
@@ -4628,7 +6035,17 @@ FRESULT f_getfree (
 		} else {
 			/* Scan FAT to obtain number of free clusters */
 			nfree = 0;
+#if FF_FREE_BITMAP
+			load_fbmp(fs);			/* Build free cluster bitmap if possible */
+			if (fs->fbmp) {			/* Count free clusters on the bitmap */
+				nfree = count_fbmp(fs);
+			} else
+#endif
+#if FF_FAT_MIRROR
+			if (fs->fs_type == FS_FAT12 || fs->fatmir) {	/* FAT12 or mirrored FAT: Scan FAT entries one by one */
+#else
 			if (fs->fs_type == FS_FAT12) {	/* FAT12: Scan bit field FAT entries */
+#endif
 				clst = 2; obj.fs = fs;
 				do {
 					stat = get_fat(&obj, clst);
@@ -4659,19 +6076,21 @@ FRESULT f_getfree (
 				} else
 #endif
 				{	/* FAT16/32: Scan WORD/DWORD FAT entries */
+					BYTE *p = 0;
+
 					clst = fs->n_fatent;	/* Number of entries */
 					sect = fs->fatbase;		/* Top of the FAT */
 					i = 0;					/* Offset in the sector */
 					do {	/* Counts numbuer of entries with zero in the FAT */
 						if (i == 0) {
-							res = move_window(fs, sect++);
-							if (res != FR_OK) break;
+							p = fat_window(fs, sect++);
+							if (!p) { res = FR_DISK_ERR; break; }
 						}
 						if (fs->fs_type == FS_FAT16) {
-							if (ld_word(fs->win + i) == 0) nfree++;
+							if (ld_word(p + i) == 0) nfree++;
 							i += 2;
 						} else {
-							if ((ld_dword(fs->win + i) & 0x0FFFFFFF) == 0) nfree++;
+							if ((ld_dword(p + i) & 0x0FFFFFFF) == 0) nfree++;
 							i += 4;
 						}
 						i %= SS(fs);
@@ -4815,6 +6234,15 @@ FRESULT f_unlink (
 			}
 			if (res == FR_OK) {
 				res = dir_remove(&dj);			/* Remove the directory entry */
+#if FF_DIR_INDEX
+				if (res == FR_OK && (dj.obj.attr & AM_DIR)) drop_dix(fs, dclst);	/* Discard index of the removed directory */
+#endif
+#if FF_PATH_CACHE
+				if (res == FR_OK && (dj.obj.attr & AM_DIR)) pc_drop(fs, dclst, 0xFFFFFFFF);	/* Discard cached paths in the removed directory */
+#endif
+#if FF_NEG_CACHE
+				if (res == FR_OK && (dj.obj.attr & AM_DIR)) nc_flush(fs);	/* Paths in it are no longer just missing files */
+#endif
 				if (res == FR_OK && dclst != 0) {	/* Remove the cluster chain if exist */
 #if FF_FS_EXFAT
 					res = remove_chain(&obj, dclst, 0);
@@ -5012,6 +6440,9 @@ FRESULT f_rename (
 			}
 			if (res == FR_OK) {
 				res = dir_remove(&djo);		/* Remove old entry */
+#if FF_PATH_CACHE
+				if (res == FR_OK && (djo.obj.attr & AM_DIR)) pc_drop(fs, 0xFFFFFFFF, 0);	/* Cached paths through the directory are no longer valid */
+#endif
 				if (res == FR_OK) {
 					res = sync_fs(fs);
 				}
@@ -5348,17 +6779,29 @@ FRESULT f_setlabel (
 FRESULT f_expand (
 	FIL* fp,		/* Pointer to the file object */
 	FSIZE_t fsz,	/* File size to be expanded to */
+#ifndef FF_EMBEDDED_FLASH
 	BYTE opt		/* Operation mode 0:Find and prepare or 1:Find and allocate */
+#else
+	BYTE opt		/* Operation mode 0:Find and prepare, 1:Find and allocate or 2:Find and reserve */
+#endif
 )
 {
 	FRESULT res;
 	FATFS *fs;
 	DWORD n, clst, stcl, scl, ncl, tcl, lclst;
+#if defined FF_EMBEDDED_FLASH && FF_USE_TRIM
+	DWORD rt[2];
+#endif
 
 
 	res = validate(&fp->obj, &fs);		/* Check validity of the file object */
 	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) LEAVE_FF(fs, res);
+#ifndef FF_EMBEDDED_FLASH
 	if (fsz == 0 || fp->obj.objsize != 0 || !(fp->flag & FA_WRITE)) LEAVE_FF(fs, FR_DENIED);
+#else
+	if (opt > 2 || (!FF_EXTENT_ALLOC && opt == 2)) LEAVE_FF(fs, FR_INVALID_PARAMETER);
+	if (fsz == 0 || fp->obj.objsize != 0 || fp->obj.sclust != 0 || !(fp->flag & FA_WRITE)) LEAVE_FF(fs, FR_DENIED);	/* (Existing chain would be lost) */
+#endif
 #if FF_FS_EXFAT
 	if (fs->fs_type != FS_EXFAT && fsz >= 0x100000000) LEAVE_FF(fs, FR_DENIED);	/* Check if in size limit */
 #endif
@@ -5413,13 +6856,30 @@ FRESULT f_expand (
 		fs->last_clst = lclst;		/* Set suggested start cluster to start next */
 		if (opt) {	/* Is it allocated now? */
 			fp->obj.sclust = scl;		/* Update object allocation information */
+#ifndef FF_EMBEDDED_FLASH
 			fp->obj.objsize = fsz;
+#else
+#if FF_EXTENT_ALLOC
+			if (opt == 2) {				/* Reserve: file size grows by writing, f_close() releases the area beyond it */
+				fp->ext_len = tcl;
+				fp->ext_rsv = 1;
+			} else
+#endif
+			{
+				fp->obj.objsize = fsz;
+			}
+#endif
 			if (FF_FS_EXFAT) fp->obj.stat = 2;	/* Set status 'contiguous chain' */
 			fp->flag |= FA_MODIFIED;
 			if (fs->free_clst <= fs->n_fatent - 2) {	/* Update FSINFO */
 				fs->free_clst -= tcl;
 				fs->fsi_flag |= 1;
 			}
+#if defined FF_EMBEDDED_FLASH && FF_USE_TRIM
+			rt[0] = clst2sect(fs, scl);					/* Start of data area allocated */
+			rt[1] = rt[0] + tcl * fs->csize - 1;		/* End of data area allocated */
+			disk_ioctl(fs->pdrv, CTRL_TRIM, rt);		/* Let the device erase the area ahead of the writes */
+#endif
 		}
 	}
 
@@ -5517,12 +6977,19 @@ FRESULT f_mkfs (
 	const TCHAR* path,	/* Logical drive number */
 	BYTE opt,			/* Format option */
 	DWORD au,			/* Size of allocation unit (cluster) [byte] */
+#ifdef FF_EMBEDDED_FLASH
+	UINT n_root,		/* Number of root directory entries for FAT volume (0: default) */
+#endif
 	void* work,			/* Pointer to working buffer (null: use heap memory) */
 	UINT len			/* Size of working buffer [byte] */
 )
 {
 	const UINT n_fats = 1;		/* Number of FATs for FAT/FAT32 volume (1 or 2) */
+#ifndef FF_EMBEDDED_FLASH
 	const UINT n_rootdir = 512;	/* Number of root directory entries for FAT volume */
+#else
+	UINT n_rootdir;				/* Number of root directory entries for FAT volume */
+#endif
 	static const WORD cst[] = {1, 4, 16, 64, 256, 512, 0};	/* Cluster size boundary for FAT volume (4Ks unit) */
 	static const WORD cst32[] = {1, 2, 4, 8, 16, 32, 0};	/* Cluster size boundary for FAT32 volume (128Ks unit) */
 	BYTE fmt, sys, *buf, *pte, pdrv, part;
@@ -5557,6 +7024,10 @@ FRESULT f_mkfs (
 #endif
 	if ((au != 0 && au < ss) || au > 0x1000000 || (au & (au - 1))) return FR_INVALID_PARAMETER;	/* Check if au is valid */
 	au /= ss;	/* Cluster size in unit of sector */
+#ifdef FF_EMBEDDED_FLASH
+	n_rootdir = n_root ? n_root : 512;
+	if (n_rootdir > 0xFFFF || n_rootdir % (ss / SZDIRE)) return FR_INVALID_PARAMETER;	/* Root directory must fill whole sectors */
+#endif
 
 	UINT heads, sz_cyl;
 	DWORD sz_disk;
@@ -5797,7 +7268,11 @@ FRESULT f_mkfs (
 				}
 				n_clst = sz_vol / pau;	/* Number of clusters */
 				sz_fat = (n_clst * 4 + 8 + ss - 1) / ss;	/* FAT size [sector] */
+#ifndef FF_EMBEDDED_FLASH
 				sz_rsv = 32;	/* Number of reserved sectors */
+#else
+				sz_rsv = ((b_vol + 32 + sz_blk - 1) & ~(sz_blk - 1)) - b_vol;	/* Number of reserved sectors (FAT aligned to erase block) */
+#endif
 				sz_dir = 0;		/* No static directory */
 				if (n_clst <= MAX_FAT16 || n_clst > MAX_FAT32) LEAVE_MKFS(FR_MKFS_ABORTED);
 			} else {				/* FAT volume */
@@ -5813,7 +7288,13 @@ FRESULT f_mkfs (
 					n = (n_clst * 3 + 1) / 2 + 3;	/* FAT size [byte] */
 				}
 				sz_fat = (n + ss - 1) / ss;		/* FAT size [sector] */
+#ifndef FF_EMBEDDED_FLASH
 				sz_rsv = 1;						/* Number of reserved sectors */
+#elif !FF_ALLOC_SUMMARY
+				sz_rsv = sz_blk - b_vol % sz_blk;	/* Number of reserved sectors (FAT aligned to erase block) */
+#else
+				sz_rsv = ((b_vol + 2 + sz_blk - 1) & ~(sz_blk - 1)) - b_vol;	/* Number of reserved sectors (VBR, summary, FAT aligned to erase block) */
+#endif
 				sz_dir = (DWORD)n_rootdir * SZDIRE / ss;	/* Rootdir size [sector] */
 			}
 			b_fat = b_vol + sz_rsv;						/* FAT base */
@@ -5821,11 +7302,16 @@ FRESULT f_mkfs (
 
 			/* Align data base to erase block boundary (for flash memory media) */
 			n = ((b_data + sz_blk - 1) & ~(sz_blk - 1)) - b_data;	/* Next nearest erase block from current data base */
+#ifndef FF_EMBEDDED_FLASH
 			if (fmt == FS_FAT32) {		/* FAT32: Move FAT base */
 				sz_rsv += n; b_fat += n;
 			} else {					/* FAT: Expand FAT size */
 				sz_fat += n / n_fats;
 			}
+#else
+			// FAT base is already aligned, expand FAT size to keep it so
+			sz_fat += n / n_fats;
+#endif
 
 			/* Determine number of clusters and final check of validity of the FAT sub-type */
 			if (sz_vol < b_data + pau * 16 - b_vol) LEAVE_MKFS(FR_MKFS_ABORTED);	/* Too small volume */
@@ -5910,6 +7396,17 @@ FRESULT f_mkfs (
 			disk_write(pdrv, buf, b_vol + 7, 1);		/* Write backup FSINFO (VBR + 7) */
 			disk_write(pdrv, buf, b_vol + 1, 1);		/* Write original FSINFO (VBR + 1) */
 		}
+#if FF_ALLOC_SUMMARY
+		else if (sz_rsv >= 2) {	/* FAT/FAT16: Create allocation summary record in FSINFO format (VBR + 1) */
+			mem_set(buf, 0, ss);
+			st_dword(buf + FSI_LeadSig, 0x41615252);
+			st_dword(buf + FSI_StrucSig, 0x61417272);
+			st_dword(buf + FSI_Free_Count, n_clst);		/* Number of free clusters */
+			st_dword(buf + FSI_Nxt_Free, 0xFFFFFFFF);	/* Last allocated cluster# (none) */
+			st_word(buf + BS_55AA, 0xAA55);
+			disk_write(pdrv, buf, b_vol + 1, 1);
+		}
+#endif
 
 		/* Initialize FAT area */
 		mem_set(buf, 0, (UINT)szb_buf);
@@ -6075,18 +7572,20 @@ FRESULT f_fdisk (
 #else
 	UINT i, n, sz_cyl, tot_cyl;
 	BYTE *p;
-	DWORD sz_part, s_part;
+	DWORD sz_part, s_part, sz_blk;
 
 	// Embedded flash does not subject to legacy compatibility constraints
 	for (n = 1; n < 256 && sz_disk / n / MBR_SECTPERHEAD > MBR_CYLN_MAX; n *= 2) ;
 	sz_cyl = MBR_SECTPERHEAD * n;
 	tot_cyl = sz_disk / sz_cyl;
+	if (disk_ioctl(pdrv, GET_BLOCK_SIZE, &sz_blk) != RES_OK || !sz_blk || (sz_blk & (sz_blk - 1))) sz_blk = 1;	/* Erase block to align partitions */
 
 	/* Create partition table */
 	mem_set(buf, 0, FF_MAX_SS);
-	p = buf + MBR_Table; s_part = 1;
+	p = buf + MBR_Table; s_part = sz_blk;	/* First partition starts after the MBR erase block */
 	for (i = 0; i < 4; i++, p += SZ_PTE) {
-		sz_part = (szt[i] <= 100U) ? (sz_disk-1) * szt[i] / 100 : szt[i];	/* Number of cylinders */
+		sz_part = (szt[i] <= 100U) ? (sz_disk-sz_blk) * szt[i] / 100 : szt[i];	/* Number of sectors */
+		sz_part &= ~(sz_blk - 1);					/* Keep following partition aligned */
 		if (sz_part == 0) continue;
 		if (s_part + sz_part > sz_disk) LEAVE_MKFS(FR_INVALID_PARAMETER);
 
@@ -124,6 +124,39 @@ typedef struct {
 	DWORD	dirbase;		/* Root directory base sector/cluster */
 	DWORD	database;		/* Data base sector */
 	DWORD	winsect;		/* Current sector appearing in the win[] */
+#if FF_FAT_MIRROR
+	BYTE*	fatmir;			/* In-memory FAT mirror followed by its dirty sector map (NULL: not mirrored) */
+	WORD	n_fatmir;		/* Number of FAT sectors in the mirror */
+#endif
+#if FF_FAT_CACHE
+	BYTE*	fcbuf;			/* FAT sector cache buffers (NULL: not available) */
+	DWORD	fcsect[FF_FAT_CACHE];	/* Sector held by each cache buffer */
+	BYTE	fcord[FF_FAT_CACHE];	/* Cache buffer indexes, most recently used first */
+	BYTE	fcdirty;		/* Dirty cache buffers (b0..b3) */
+	DWORD	fc_hit;			/* Number of FAT cache hits */
+	DWORD	fc_miss;		/* Number of FAT cache misses */
+	DWORD	fc_wback;		/* Number of FAT cache write-backs */
+#endif
+#if FF_FREE_BITMAP
+	DWORD*	fbmp;			/* Free cluster bitmap, bit set: cluster in use (NULL: not built) */
+#endif
+#if FF_DIR_INDEX
+	void*	dix;			/* Directory hash indexes, most recently used first */
+	DWORD	dix_heap;		/* Heap used by the directory hash indexes [byte] */
+#endif
+#if FF_PATH_CACHE || FF_NEG_CACHE
+	DWORD	pc_tick;		/* Path lookup cache use counter */
+#endif
+#if FF_PATH_CACHE
+	void*	pcache;			/* Path lookup cache entries (NULL: not allocated) */
+	DWORD	pc_hit;			/* Number of path lookup cache hits */
+	DWORD	pc_miss;		/* Number of path lookup cache misses */
+#endif
+#if FF_NEG_CACHE
+	void*	ncache;			/* Negative lookup cache entries (NULL: not allocated) */
+	DWORD	nc_hit;			/* Number of missing paths answered from the cache */
+	DWORD	nc_miss;		/* Number of missing paths found by a directory walk */
+#endif
 	BYTE	win[FF_MAX_SS];	/* Disk access window for Directory, FAT (and file data at tiny cfg) */
 } FATFS;
 
@@ -168,6 +201,10 @@ typedef struct {
 #if FF_USE_FASTSEEK
 	DWORD*	cltbl;			/* Pointer to the cluster link map table (nulled on open, set by application) */
 #endif
+#if FF_EXTENT_ALLOC && !FF_FS_READONLY
+	DWORD	ext_len;		/* Size of the last allocated extent (0:nothing allocated since open or sync) */
+	BYTE	ext_rsv;		/* Reserved chain is kept until close (f_expand mode 2) */
+#endif
 #if !FF_FS_TINY
 	BYTE	buf[FF_MAX_SS];	/* File private data read/write window */
 #endif
@@ -267,7 +304,11 @@ FRESULT f_setlabel (const TCHAR* label);							/* Set volume label */
 FRESULT f_forward (FIL* fp, UINT(*func)(const BYTE*,UINT), UINT btf, UINT* bf);	/* Forward data to the stream */
 FRESULT f_expand (FIL* fp, FSIZE_t szf, BYTE opt);					/* Allocate a contiguous block to the file */
 FRESULT f_mount (FATFS* fs, const TCHAR* path, BYTE opt);			/* Mount/Unmount a logical drive */
+#ifndef FF_EMBEDDED_FLASH
 FRESULT f_mkfs (const TCHAR* path, BYTE opt, DWORD au, void* work, UINT len);	/* Create a FAT volume */
+#else
+FRESULT f_mkfs (const TCHAR* path, BYTE opt, DWORD au, UINT n_root, void* work, UINT len);	/* Create a FAT volume */
+#endif
 FRESULT f_fdisk (BYTE pdrv, const DWORD* szt, void* work);			/* Divide a physical drive into some partitions */
 FRESULT f_setcp (WORD cp);											/* Set current code page */
 int f_putc (TCHAR c, FIL* fp);										/* Put a character to the file */
@@ -305,7 +346,7 @@ WCHAR ff_oem2uni (WCHAR oem, WORD cp);	/* OEM code to Unicode conversion */
 WCHAR ff_uni2oem (DWORD uni, WORD cp);	/* Unicode to OEM code conversion */
 DWORD ff_wtoupper (DWORD uni);			/* Unicode upper-case conversion */
 #endif
-#if FF_USE_LFN == 3						/* Dynamic memory allocation */
+#if FF_USE_LFN == 3 || FF_FAT_MIRROR || FF_FAT_CACHE || FF_FREE_BITMAP || FF_DIR_INDEX || FF_PATH_CACHE || FF_NEG_CACHE	/* Dynamic memory allocation */
 void* ff_memalloc (UINT msize);			/* Allocate memory block */
 void ff_memfree (void* mblock);			/* Free memory block */
 #endif
@@ -45,12 +45,17 @@
 /* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_FASTSEEK	0
+#define FF_USE_FASTSEEK	1
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_EXPAND	0
-/* This option switches f_expand function. (0:Disable or 1:Enable) */
+#define FF_USE_EXPAND	1
+/* This option switches f_expand function. (0:Disable or 1:Enable)
+/  At embedded flash config, allocated area is trimmed for pre-erase, and mode 2
+/  (allocate and keep file size, requires FF_EXTENT_ALLOC) is available. The
+/  reservation is kept across f_sync() and the part beyond the file size is
+/  released at f_close(). Until the file has data, f_sync() records no chain
+/  in the directory entry. */
 
 
 #define FF_USE_CHMOD	1
@@ -152,7 +157,7 @@
 */
 
 
-#define FF_FS_RPATH		0
+#define FF_FS_RPATH		1
 /* This option configures support for relative path.
 /
 /   0: Disable relative path and remove related functions.
@@ -227,6 +232,99 @@
 /  buffer in the filesystem object (FATFS) is used for the file data transfer. */
 
 
+#define FF_FAT_MIRROR	0
+/* This option sets the heap budget [byte] of the in-memory FAT mirror. (0:Disable)
+/  When the FAT of a volume fits in the budget, it is loaded into a heap buffer
+/  at mount time. FAT reads are then served from memory and modified FAT sectors
+/  are written back at sync. Volumes with larger FAT are accessed as usual.
+/  e.g. 8192 covers FAT16 volumes of up to about 4K clusters, at the cost of
+/  that much heap per mounted volume.
+/  Heap memory functions, ff_memalloc() and ff_memfree(), need to be added
+/  to the project. */
+
+
+#define FF_FAT_CACHE	0
+/* This option sets number of FAT sectors cached apart from the sector window
+/  win[] in the filesystem object. (0:Disable or 1-4)
+/  The cache buffers are allocated from heap at mount time, so that FAT accesses
+/  of cluster chain operations do not evict directory and file data from win[].
+/  Each cached sector takes FF_MAX_SS bytes of heap per mounted volume. Hit,
+/  miss and write-back counts are kept in the filesystem object to help sizing.
+/  Volumes with in-memory FAT mirror (FF_FAT_MIRROR) do not use the cache. */
+
+
+#define FF_ALLOC_SUMMARY	0
+/* This option switches the allocation summary record on FAT/FAT16 volumes.
+/  (0:Disable or 1:Enable)
+/  When enabled, f_mkfs() reserves the sector next to the VBR of FAT/FAT16
+/  volumes for a record in FSInfo format, which holds the number of free
+/  clusters and the last allocated cluster like FSInfo on FAT32 volumes.
+/  On all FAT types, the record is marked invalid on the disk before the first
+/  FAT change, and rewritten at sync or unmount. A valid record is trusted at
+/  mount time if its values are in range of the volume, so that the first
+/  f_getfree() does not need a full FAT scan.
+/  Note that the record sector is written twice per sync with FAT changes (one
+/  invalidation and one update), costing erases on flash media, and that the
+/  option changes the volume layout created by f_mkfs(). */
+
+
+#define FF_EXTENT_ALLOC	16
+/* This option sets the maximum number of clusters f_write() allocates at once
+/  as a contiguous extent. (0:Disable or 2-)
+/  When a file needs a new cluster, the extent is sized by the rest of the write
+/  request, or doubled on each further stretch for sequential writers. It is
+/  linked to the file at once, taken from the free run next to the file end if
+/  possible, else from the smallest free run that fits (best-fit). Clusters
+/  beyond the file size are released at f_sync() and f_close(), so that the
+/  chain on the disk never goes beyond the file size. */
+
+
+#define FF_DIR_INDEX	0
+/* This option sets the heap budget [byte] of the directory hash indexes.
+/  (0:Disable)
+/  A directory is indexed at its first lookup, one byte per directory entry,
+/  holding a hash of the up-cased name of the object starting at the entry.
+/  Lookups then compare only the entries with matching hash. The index is kept
+/  updated on object creation and removal, and the least recently used index is
+/  discarded to stay in the budget. Lookups by numbered SFN (with '~') are done
+/  by linear search. e.g. 1024 indexes up to 1024 directory entries in total.
+/  This option requires LFN enabled (FF_USE_LFN >= 1). */
+
+
+#define FF_PATH_CACHE		0
+#define FF_PATH_CACHE_LEN	64
+/* FF_PATH_CACHE sets the number of entries in the path lookup cache. (0:Disable)
+/  Each entry maps a full path (shorter than FF_PATH_CACHE_LEN bytes) to the
+/  containing directory and the location of the object in it, so that a repeated
+/  lookup of the path reads only the sector of the object instead of following
+/  every segment. The cache is allocated from heap at the first lookup, the least
+/  recently used entry is replaced. The object name is compared again at each
+/  hit, and directory removal or rename discards the affected entries.
+/  Each entry takes FF_PATH_CACHE_LEN + 16 bytes of heap; hit and miss counts
+/  are kept in the filesystem object to help sizing the cache.
+/  This option requires LFN enabled (FF_USE_LFN >= 1). */
+
+
+#define FF_NEG_CACHE	0
+/* FF_NEG_CACHE sets the number of entries in the negative lookup cache. (0:Disable)
+/  Each entry records a full path (shorter than FF_PATH_CACHE_LEN bytes) that was
+/  found not to exist, so that probing the same missing path again is answered
+/  without reading any directory sector. Any object creation or directory removal
+/  on the volume discards all the entries. Entries are sized as those of the
+/  path lookup cache.
+/  This option requires LFN enabled (FF_USE_LFN >= 1). */
+
+
+#define FF_FREE_BITMAP	0
+/* This option sets the heap budget [byte] of the free cluster bitmap. (0:Disable)
+/  The bitmap holds one bit per cluster. It is built at the first cluster
+/  allocation or free space query on a FAT/FAT32 volume, and kept updated on
+/  every FAT change. Free clusters are then found and counted on the bitmap
+/  instead of scanning the FAT. Volumes with more clusters than the budget
+/  allows scan the FAT as usual. e.g. 1024 covers volumes up to 8K clusters.
+/  This option must be 0 at read-only config. */
+
+
 #define FF_FS_EXFAT		0
 /* This option switches support for exFAT filesystem. (0:Disable or 1:Enable)
 /  When enable exFAT, also LFN needs to be enabled.
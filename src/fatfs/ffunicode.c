@@ -15031,6 +15031,28 @@ const WCHAR uc437[] PROGMEM = {	/*  CP437(U.S.) to Unicode conversion table */
 	0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 437
+static
+const WCHAR uni2oem437[] PROGMEM = {	/* Unicode --> CP437 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A1, 0x00AD, 0x00A2, 0x009B, 0x00A3, 0x009C,	0x00A5, 0x009D, 0x00AA, 0x00A6, 0x00AB, 0x00AE, 0x00AC, 0x00AA,
+	0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x00FD, 0x00B5, 0x00E6,	0x00B7, 0x00FA, 0x00BA, 0x00A7, 0x00BB, 0x00AF, 0x00BC, 0x00AC,
+	0x00BD, 0x00AB, 0x00BF, 0x00A8, 0x00C4, 0x008E, 0x00C5, 0x008F,	0x00C6, 0x0092, 0x00C7, 0x0080, 0x00C9, 0x0090, 0x00D1, 0x00A5,
+	0x00D6, 0x0099, 0x00DC, 0x009A, 0x00DF, 0x00E1, 0x00E0, 0x0085,	0x00E1, 0x00A0, 0x00E2, 0x0083, 0x00E4, 0x0084, 0x00E5, 0x0086,
+	0x00E6, 0x0091, 0x00E7, 0x0087, 0x00E8, 0x008A, 0x00E9, 0x0082,	0x00EA, 0x0088, 0x00EB, 0x0089, 0x00EC, 0x008D, 0x00ED, 0x00A1,
+	0x00EE, 0x008C, 0x00EF, 0x008B, 0x00F1, 0x00A4, 0x00F2, 0x0095,	0x00F3, 0x00A2, 0x00F4, 0x0093, 0x00F6, 0x0094, 0x00F7, 0x00F6,
+	0x00F9, 0x0097, 0x00FA, 0x00A3, 0x00FB, 0x0096, 0x00FC, 0x0081,	0x00FF, 0x0098, 0x0192, 0x009F, 0x0393, 0x00E2, 0x0398, 0x00E9,
+	0x03A3, 0x00E4, 0x03A6, 0x00E8, 0x03A9, 0x00EA, 0x03B1, 0x00E0,	0x03B4, 0x00EB, 0x03B5, 0x00EE, 0x03C0, 0x00E3, 0x03C3, 0x00E5,
+	0x03C4, 0x00E7, 0x03C6, 0x00ED, 0x207F, 0x00FC, 0x20A7, 0x009E,	0x2219, 0x00F9, 0x221A, 0x00FB, 0x221E, 0x00EC, 0x2229, 0x00EF,
+	0x2248, 0x00F7, 0x2261, 0x00F0, 0x2264, 0x00F3, 0x2265, 0x00F2,	0x2310, 0x00A9, 0x2320, 0x00F4, 0x2321, 0x00F5, 0x2500, 0x00C4,
+	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,
+	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,	0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8,
+	0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00D4, 0x2559, 0x00D3,	0x255A, 0x00C8, 0x255B, 0x00BE, 0x255C, 0x00BD, 0x255D, 0x00BC,
+	0x255E, 0x00C6, 0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5,	0x2562, 0x00B6, 0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2,
+	0x2566, 0x00CB, 0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA,	0x256A, 0x00D8, 0x256B, 0x00D7, 0x256C, 0x00CE, 0x2580, 0x00DF,
+	0x2584, 0x00DC, 0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 720 || FF_CODE_PAGE == 0
 static
 const WCHAR uc720[] PROGMEM = {	/*  CP720(Arabic) to Unicode conversion table */
@@ -15044,6 +15066,27 @@ const WCHAR uc720[] PROGMEM = {	/*  CP720(Arabic) to Unicode conversion table */
 	0x2261, 0x064B, 0x064C, 0x064D, 0x064E, 0x064F, 0x0650, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 720
+static
+const WCHAR uni2oem720[] PROGMEM = {	/* Unicode --> CP720 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A3, 0x009C, 0x00A4, 0x0094, 0x00AB, 0x00AE,	0x00B0, 0x00F8, 0x00B2, 0x00FD, 0x00B5, 0x00E6, 0x00B7, 0x00FA,
+	0x00BB, 0x00AF, 0x00E0, 0x0085, 0x00E2, 0x0083, 0x00E7, 0x0087,	0x00E8, 0x008A, 0x00E9, 0x0082, 0x00EA, 0x0088, 0x00EB, 0x0089,
+	0x00EE, 0x008C, 0x00EF, 0x008B, 0x00F4, 0x0093, 0x00F9, 0x0097,	0x00FB, 0x0096, 0x0621, 0x0098, 0x0622, 0x0099, 0x0623, 0x009A,
+	0x0624, 0x009B, 0x0625, 0x009D, 0x0626, 0x009E, 0x0627, 0x009F,	0x0628, 0x00A0, 0x0629, 0x00A1, 0x062A, 0x00A2, 0x062B, 0x00A3,
+	0x062C, 0x00A4, 0x062D, 0x00A5, 0x062E, 0x00A6, 0x062F, 0x00A7,	0x0630, 0x00A8, 0x0631, 0x00A9, 0x0632, 0x00AA, 0x0633, 0x00AB,
+	0x0634, 0x00AC, 0x0635, 0x00AD, 0x0636, 0x00E0, 0x0637, 0x00E1,	0x0638, 0x00E2, 0x0639, 0x00E3, 0x063A, 0x00E4, 0x0640, 0x0095,
+	0x0641, 0x00E5, 0x0642, 0x00E7, 0x0643, 0x00E8, 0x0644, 0x00E9,	0x0645, 0x00EA, 0x0646, 0x00EB, 0x0647, 0x00EC, 0x0648, 0x00ED,
+	0x0649, 0x00EE, 0x064A, 0x00EF, 0x064B, 0x00F1, 0x064C, 0x00F2,	0x064D, 0x00F3, 0x064E, 0x00F4, 0x064F, 0x00F5, 0x0650, 0x00F6,
+	0x0651, 0x0091, 0x0652, 0x0092, 0x207F, 0x00FC, 0x2219, 0x00F9,	0x221A, 0x00FB, 0x2248, 0x00F7, 0x2261, 0x00F0, 0x2500, 0x00C4,
+	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,
+	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,	0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8,
+	0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00D4, 0x2559, 0x00D3,	0x255A, 0x00C8, 0x255B, 0x00BE, 0x255C, 0x00BD, 0x255D, 0x00BC,
+	0x255E, 0x00C6, 0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5,	0x2562, 0x00B6, 0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2,
+	0x2566, 0x00CB, 0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA,	0x256A, 0x00D8, 0x256B, 0x00D7, 0x256C, 0x00CE, 0x2580, 0x00DF,
+	0x2584, 0x00DC, 0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 737 || FF_CODE_PAGE == 0
 static
 const WCHAR uc737[] PROGMEM = {	/*  CP737(Greek) to Unicode conversion table */
@@ -15057,6 +15100,28 @@ const WCHAR uc737[] PROGMEM = {	/*  CP737(Greek) to Unicode conversion table */
 	0x038F, 0x00B1, 0x2265, 0x2264, 0x03AA, 0x03AB, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 737
+static
+const WCHAR uni2oem737[] PROGMEM = {	/* Unicode --> CP737 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x00FD,	0x00B7, 0x00FA, 0x00F7, 0x00F6, 0x0386, 0x00EA, 0x0388, 0x00EB,
+	0x0389, 0x00EC, 0x038A, 0x00ED, 0x038C, 0x00EE, 0x038E, 0x00EF,	0x038F, 0x00F0, 0x0391, 0x0080, 0x0392, 0x0081, 0x0393, 0x0082,
+	0x0394, 0x0083, 0x0395, 0x0084, 0x0396, 0x0085, 0x0397, 0x0086,	0x0398, 0x0087, 0x0399, 0x0088, 0x039A, 0x0089, 0x039B, 0x008A,
+	0x039C, 0x008B, 0x039D, 0x008C, 0x039E, 0x008D, 0x039F, 0x008E,	0x03A0, 0x008F, 0x03A1, 0x0090, 0x03A3, 0x0091, 0x03A4, 0x0092,
+	0x03A5, 0x0093, 0x03A6, 0x0094, 0x03A7, 0x0095, 0x03A8, 0x0096,	0x03A9, 0x0097, 0x03AA, 0x00F4, 0x03AB, 0x00F5, 0x03AC, 0x00E1,
+	0x03AD, 0x00E2, 0x03AE, 0x00E3, 0x03AF, 0x00E5, 0x03B1, 0x0098,	0x03B2, 0x0099, 0x03B3, 0x009A, 0x03B4, 0x009B, 0x03B5, 0x009C,
+	0x03B6, 0x009D, 0x03B7, 0x009E, 0x03B8, 0x009F, 0x03B9, 0x00A0,	0x03BA, 0x00A1, 0x03BB, 0x00A2, 0x03BC, 0x00A3, 0x03BD, 0x00A4,
+	0x03BE, 0x00A5, 0x03BF, 0x00A6, 0x03C0, 0x00A7, 0x03C1, 0x00A8,	0x03C2, 0x00AA, 0x03C3, 0x00A9, 0x03C4, 0x00AB, 0x03C5, 0x00AC,
+	0x03C6, 0x00AD, 0x03C7, 0x00AE, 0x03C8, 0x00AF, 0x03C9, 0x00E0,	0x03CA, 0x00E4, 0x03CB, 0x00E8, 0x03CC, 0x00E6, 0x03CD, 0x00E7,
+	0x03CE, 0x00E9, 0x207F, 0x00FC, 0x2219, 0x00F9, 0x221A, 0x00FB,	0x2248, 0x00F7, 0x2264, 0x00F3, 0x2265, 0x00F2, 0x2500, 0x00C4,
+	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,
+	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,	0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8,
+	0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00D4, 0x2559, 0x00D3,	0x255A, 0x00C8, 0x255B, 0x00BE, 0x255C, 0x00BD, 0x255D, 0x00BC,
+	0x255E, 0x00C6, 0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5,	0x2562, 0x00B6, 0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2,
+	0x2566, 0x00CB, 0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA,	0x256A, 0x00D8, 0x256B, 0x00D7, 0x256C, 0x00CE, 0x2580, 0x00DF,
+	0x2584, 0x00DC, 0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 771 || FF_CODE_PAGE == 0
 static
 const WCHAR uc771[] PROGMEM = {	/*  CP771(KBL) to Unicode conversion table */
@@ -15070,6 +15135,27 @@ const WCHAR uc771[] PROGMEM = {	/*  CP771(KBL) to Unicode conversion table */
 	0x0118, 0x0119, 0x0116, 0x0117, 0x012E, 0x012F, 0x0160, 0x0161, 0x0172, 0x0173, 0x016A, 0x016B, 0x017D, 0x017E, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 771
+static
+const WCHAR uni2oem771[] PROGMEM = {	/* Unicode --> CP771 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x0104, 0x00DC, 0x0105, 0x00DD, 0x010C, 0x00DE,	0x010D, 0x00DF, 0x0116, 0x00F2, 0x0117, 0x00F3, 0x0118, 0x00F0,
+	0x0119, 0x00F1, 0x012E, 0x00F4, 0x012F, 0x00F5, 0x0160, 0x00F6,	0x0161, 0x00F7, 0x016A, 0x00FA, 0x016B, 0x00FB, 0x0172, 0x00F8,
+	0x0173, 0x00F9, 0x017D, 0x00FC, 0x017E, 0x00FD, 0x0410, 0x0080,	0x0411, 0x0081, 0x0412, 0x0082, 0x0413, 0x0083, 0x0414, 0x0084,
+	0x0415, 0x0085, 0x0416, 0x0086, 0x0417, 0x0087, 0x0418, 0x0088,	0x0419, 0x0089, 0x041A, 0x008A, 0x041B, 0x008B, 0x041C, 0x008C,
+	0x041D, 0x008D, 0x041E, 0x008E, 0x041F, 0x008F, 0x0420, 0x0090,	0x0421, 0x0091, 0x0422, 0x0092, 0x0423, 0x0093, 0x0424, 0x0094,
+	0x0425, 0x0095, 0x0426, 0x0096, 0x0427, 0x0097, 0x0428, 0x0098,	0x0429, 0x0099, 0x042A, 0x009A, 0x042B, 0x009B, 0x042C, 0x009C,
+	0x042D, 0x009D, 0x042E, 0x009E, 0x042F, 0x009F, 0x0430, 0x00A0,	0x0431, 0x00A1, 0x0432, 0x00A2, 0x0433, 0x00A3, 0x0434, 0x00A4,
+	0x0435, 0x00A5, 0x0436, 0x00A6, 0x0437, 0x00A7, 0x0438, 0x00A8,	0x0439, 0x00A9, 0x043A, 0x00AA, 0x043B, 0x00AB, 0x043C, 0x00AC,
+	0x043D, 0x00AD, 0x043E, 0x00AE, 0x043F, 0x00AF, 0x0440, 0x00E0,	0x0441, 0x00E1, 0x0442, 0x00E2, 0x0443, 0x00E3, 0x0444, 0x00E4,
+	0x0445, 0x00E5, 0x0446, 0x00E6, 0x0447, 0x00E7, 0x0448, 0x00E8,	0x0449, 0x00E9, 0x044A, 0x00EA, 0x044B, 0x00EB, 0x044C, 0x00EC,
+	0x044D, 0x00ED, 0x044E, 0x00EE, 0x044F, 0x00EF, 0x2500, 0x00C4,	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,
+	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,
+	0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8,	0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00BE, 0x2559, 0x00D3,
+	0x255A, 0x00C8, 0x255C, 0x00BD, 0x255D, 0x00BC, 0x255E, 0x00C6,	0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5, 0x2562, 0x00B6,
+	0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2, 0x2566, 0x00CB,	0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA, 0x256A, 0x00D8,
+	0x256B, 0x00D7, 0x256C, 0x00CE, 0x2588, 0x00DB, 0x2591, 0x00B0,	0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE, 0, 0
+};
+#endif
 #if FF_CODE_PAGE == 775 || FF_CODE_PAGE == 0
 static
 const WCHAR uc775[] PROGMEM = {	/*  CP775(Baltic) to Unicode conversion table */
@@ -15083,6 +15169,28 @@ const WCHAR uc775[] PROGMEM = {	/*  CP775(Baltic) to Unicode conversion table */
 	0x00AD, 0x00B1, 0x201C, 0x00BE, 0x00B6, 0x00A7, 0x00F7, 0x201E, 0x00B0, 0x2219, 0x00B7, 0x00B9, 0x00B3, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 775
+static
+const WCHAR uni2oem775[] PROGMEM = {	/* Unicode --> CP775 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A2, 0x0096, 0x00A3, 0x009C, 0x00A4, 0x009F,	0x00A6, 0x00A7, 0x00A7, 0x00F5, 0x00A9, 0x00A8, 0x00AB, 0x00AE,
+	0x00AC, 0x00AA, 0x00AD, 0x00F0, 0x00AE, 0x00A9, 0x00B0, 0x00F8,	0x00B1, 0x00F1, 0x00B2, 0x00FD, 0x00B3, 0x00FC, 0x00B5, 0x00E6,
+	0x00B6, 0x00F4, 0x00B7, 0x00FA, 0x00B9, 0x00FB, 0x00BB, 0x00AF,	0x00BC, 0x00AC, 0x00BD, 0x00AB, 0x00BE, 0x00F3, 0x00C4, 0x008E,
+	0x00C5, 0x008F, 0x00C6, 0x0092, 0x00C9, 0x0090, 0x00D3, 0x00E0,	0x00D5, 0x00E5, 0x00D6, 0x0099, 0x00D7, 0x009E, 0x00D8, 0x009D,
+	0x00DC, 0x009A, 0x00DF, 0x00E1, 0x00E4, 0x0084, 0x00E5, 0x0086,	0x00E6, 0x0091, 0x00E9, 0x0082, 0x00F3, 0x00A2, 0x00F5, 0x00E4,
+	0x00F6, 0x0094, 0x00F7, 0x00F6, 0x00F8, 0x009B, 0x00FC, 0x0081,	0x0100, 0x00A0, 0x0101, 0x0083, 0x0104, 0x00B5, 0x0105, 0x00D0,
+	0x0106, 0x0080, 0x0107, 0x0087, 0x010C, 0x00B6, 0x010D, 0x00D1,	0x0112, 0x00ED, 0x0113, 0x0089, 0x0116, 0x00B8, 0x0117, 0x00D3,
+	0x0118, 0x00B7, 0x0119, 0x00D2, 0x0122, 0x0095, 0x0123, 0x0085,	0x012A, 0x00A1, 0x012B, 0x008C, 0x012E, 0x00BD, 0x012F, 0x00D4,
+	0x0136, 0x00E8, 0x0137, 0x00E9, 0x013B, 0x00EA, 0x013C, 0x00EB,	0x0141, 0x00AD, 0x0142, 0x0088, 0x0143, 0x00E3, 0x0144, 0x00E7,
+	0x0145, 0x00EE, 0x0146, 0x00EC, 0x014C, 0x00E2, 0x014D, 0x0093,	0x0156, 0x008A, 0x0157, 0x008B, 0x015A, 0x0097, 0x015B, 0x0098,
+	0x0160, 0x00BE, 0x0161, 0x00D5, 0x016A, 0x00C7, 0x016B, 0x00D7,	0x0172, 0x00C6, 0x0173, 0x00D6, 0x0179, 0x008D, 0x017A, 0x00A5,
+	0x017B, 0x00A3, 0x017C, 0x00A4, 0x017D, 0x00CF, 0x017E, 0x00D8,	0x2019, 0x00EF, 0x201C, 0x00F2, 0x201D, 0x00A6, 0x201E, 0x00F7,
+	0x2219, 0x00F9, 0x2500, 0x00C4, 0x2502, 0x00B3, 0x250C, 0x00DA,	0x2510, 0x00BF, 0x2514, 0x00C0, 0x2518, 0x00D9, 0x251C, 0x00C3,
+	0x2524, 0x00B4, 0x252C, 0x00C2, 0x2534, 0x00C1, 0x253C, 0x00C5,	0x2550, 0x00CD, 0x2551, 0x00BA, 0x2554, 0x00C9, 0x2557, 0x00BB,
+	0x255A, 0x00C8, 0x255D, 0x00BC, 0x2560, 0x00CC, 0x2563, 0x00B9,	0x2566, 0x00CB, 0x2569, 0x00CA, 0x256C, 0x00CE, 0x2580, 0x00DF,
+	0x2584, 0x00DC, 0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 850 || FF_CODE_PAGE == 0
 static
 const WCHAR uc850[] PROGMEM = {	/*  CP850(Latin 1) to Unicode conversion table */
@@ -15096,6 +15204,28 @@ const WCHAR uc850[] PROGMEM = {	/*  CP850(Latin 1) to Unicode conversion table *
 	0x00AD, 0x00B1, 0x2017, 0x00BE, 0x00B6, 0x00A7, 0x00F7, 0x00B8, 0x00B0, 0x00A8, 0x00B7, 0x00B9, 0x00B3, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 850
+static
+const WCHAR uni2oem850[] PROGMEM = {	/* Unicode --> CP850 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A1, 0x00AD, 0x00A2, 0x00BD, 0x00A3, 0x009C,	0x00A4, 0x00CF, 0x00A5, 0x00BE, 0x00A6, 0x00DD, 0x00A7, 0x00F5,
+	0x00A8, 0x00F9, 0x00A9, 0x00B8, 0x00AA, 0x00A6, 0x00AB, 0x00AE,	0x00AC, 0x00AA, 0x00AD, 0x00F0, 0x00AE, 0x00A9, 0x00AF, 0x00EE,
+	0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x00FD, 0x00B3, 0x00FC,	0x00B4, 0x00EF, 0x00B5, 0x00E6, 0x00B6, 0x00F4, 0x00B7, 0x00FA,
+	0x00B8, 0x00F7, 0x00B9, 0x00FB, 0x00BA, 0x00A7, 0x00BB, 0x00AF,	0x00BC, 0x00AC, 0x00BD, 0x00AB, 0x00BE, 0x00F3, 0x00BF, 0x00A8,
+	0x00C0, 0x00B7, 0x00C1, 0x00B5, 0x00C2, 0x00B6, 0x00C3, 0x00C7,	0x00C4, 0x008E, 0x00C5, 0x008F, 0x00C6, 0x0092, 0x00C7, 0x0080,
+	0x00C8, 0x00D4, 0x00C9, 0x0090, 0x00CA, 0x00D2, 0x00CB, 0x00D3,	0x00CC, 0x00DE, 0x00CD, 0x00D6, 0x00CE, 0x00D7, 0x00CF, 0x00D8,
+	0x00D0, 0x00D1, 0x00D1, 0x00A5, 0x00D2, 0x00E3, 0x00D3, 0x00E0,	0x00D4, 0x00E2, 0x00D5, 0x00E5, 0x00D6, 0x0099, 0x00D7, 0x009E,
+	0x00D8, 0x009D, 0x00D9, 0x00EB, 0x00DA, 0x00E9, 0x00DB, 0x00EA,	0x00DC, 0x009A, 0x00DD, 0x00ED, 0x00DE, 0x00E8, 0x00DF, 0x00E1,
+	0x00E0, 0x0085, 0x00E1, 0x00A0, 0x00E2, 0x0083, 0x00E3, 0x00C6,	0x00E4, 0x0084, 0x00E5, 0x0086, 0x00E6, 0x0091, 0x00E7, 0x0087,
+	0x00E8, 0x008A, 0x00E9, 0x0082, 0x00EA, 0x0088, 0x00EB, 0x0089,	0x00EC, 0x008D, 0x00ED, 0x00A1, 0x00EE, 0x008C, 0x00EF, 0x008B,
+	0x00F0, 0x00D0, 0x00F1, 0x00A4, 0x00F2, 0x0095, 0x00F3, 0x00A2,	0x00F4, 0x0093, 0x00F5, 0x00E4, 0x00F6, 0x0094, 0x00F7, 0x00F6,
+	0x00F8, 0x009B, 0x00F9, 0x0097, 0x00FA, 0x00A3, 0x00FB, 0x0096,	0x00FC, 0x0081, 0x00FD, 0x00EC, 0x00FE, 0x00E7, 0x00FF, 0x0098,
+	0x0131, 0x00D5, 0x0192, 0x009F, 0x2017, 0x00F2, 0x2500, 0x00C4,	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,
+	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,
+	0x2554, 0x00C9, 0x2557, 0x00BB, 0x255A, 0x00C8, 0x255D, 0x00BC,	0x2560, 0x00CC, 0x2563, 0x00B9, 0x2566, 0x00CB, 0x2569, 0x00CA,
+	0x256C, 0x00CE, 0x2580, 0x00DF, 0x2584, 0x00DC, 0x2588, 0x00DB,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 852 || FF_CODE_PAGE == 0
 static
 const WCHAR uc852[] PROGMEM = {	/*  CP852(Latin 2) to Unicode conversion table */
@@ -15109,6 +15239,28 @@ const WCHAR uc852[] PROGMEM = {	/*  CP852(Latin 2) to Unicode conversion table *
 	0x00AD, 0x02DD, 0x02DB, 0x02C7, 0x02D8, 0x00A7, 0x00F7, 0x00B8, 0x00B0, 0x00A8, 0x02D9, 0x0171, 0x0158, 0x0159, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 852
+static
+const WCHAR uni2oem852[] PROGMEM = {	/* Unicode --> CP852 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A4, 0x00CF, 0x00A7, 0x00F5, 0x00A8, 0x00F9,	0x00AB, 0x00AE, 0x00AC, 0x00AA, 0x00AD, 0x00F0, 0x00B0, 0x00F8,
+	0x00B4, 0x00EF, 0x00B8, 0x00F7, 0x00BB, 0x00AF, 0x00C1, 0x00B5,	0x00C2, 0x00B6, 0x00C4, 0x008E, 0x00C7, 0x0080, 0x00C9, 0x0090,
+	0x00CB, 0x00D3, 0x00CD, 0x00D6, 0x00CE, 0x00D7, 0x00D3, 0x00E0,	0x00D4, 0x00E2, 0x00D6, 0x0099, 0x00D7, 0x009E, 0x00DA, 0x00E9,
+	0x00DC, 0x009A, 0x00DD, 0x00ED, 0x00DF, 0x00E1, 0x00E1, 0x00A0,	0x00E2, 0x0083, 0x00E4, 0x0084, 0x00E7, 0x0087, 0x00E9, 0x0082,
+	0x00EB, 0x0089, 0x00ED, 0x00A1, 0x00EE, 0x008C, 0x00F3, 0x00A2,	0x00F4, 0x0093, 0x00F6, 0x0094, 0x00F7, 0x00F6, 0x00FA, 0x00A3,
+	0x00FC, 0x0081, 0x00FD, 0x00EC, 0x0102, 0x00C6, 0x0103, 0x00C7,	0x0104, 0x00A4, 0x0105, 0x00A5, 0x0106, 0x008F, 0x0107, 0x0086,
+	0x010C, 0x00AC, 0x010D, 0x009F, 0x010E, 0x00D2, 0x010F, 0x00D4,	0x0110, 0x00D1, 0x0111, 0x00D0, 0x0118, 0x00A8, 0x0119, 0x00A9,
+	0x011A, 0x00B7, 0x011B, 0x00D8, 0x0139, 0x0091, 0x013A, 0x0092,	0x013D, 0x0095, 0x013E, 0x0096, 0x0141, 0x009D, 0x0142, 0x0088,
+	0x0143, 0x00E3, 0x0144, 0x00E4, 0x0147, 0x00D5, 0x0148, 0x00E5,	0x0150, 0x008A, 0x0151, 0x008B, 0x0154, 0x00E8, 0x0155, 0x00EA,
+	0x0158, 0x00FC, 0x0159, 0x00FD, 0x015A, 0x0097, 0x015B, 0x0098,	0x015E, 0x00B8, 0x015F, 0x00AD, 0x0160, 0x00E6, 0x0161, 0x00E7,
+	0x0162, 0x00DD, 0x0163, 0x00EE, 0x0164, 0x009B, 0x0165, 0x009C,	0x016E, 0x00DE, 0x016F, 0x0085, 0x0170, 0x00EB, 0x0171, 0x00FB,
+	0x0179, 0x008D, 0x017A, 0x00AB, 0x017B, 0x00BD, 0x017C, 0x00BE,	0x017D, 0x00A6, 0x017E, 0x00A7, 0x02C7, 0x00F3, 0x02D8, 0x00F4,
+	0x02D9, 0x00FA, 0x02DB, 0x00F2, 0x02DD, 0x00F1, 0x2500, 0x00C4,	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,
+	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,
+	0x2554, 0x00C9, 0x2557, 0x00BB, 0x255A, 0x00C8, 0x255D, 0x00BC,	0x2560, 0x00CC, 0x2563, 0x00B9, 0x2566, 0x00CB, 0x2569, 0x00CA,
+	0x256C, 0x00CE, 0x2580, 0x00DF, 0x2584, 0x00DC, 0x2588, 0x00DB,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 855 || FF_CODE_PAGE == 0
 static
 const WCHAR uc855[] PROGMEM = {	/*  CP855(Cyrillic) to Unicode conversion table */
@@ -15122,6 +15274,28 @@ const WCHAR uc855[] PROGMEM = {	/*  CP855(Cyrillic) to Unicode conversion table
 	0x00AD, 0x044B, 0x042B, 0x0437, 0x0417, 0x0448, 0x0428, 0x044D, 0x042D, 0x0449, 0x0429, 0x0447, 0x0427, 0x00A7, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 855
+static
+const WCHAR uni2oem855[] PROGMEM = {	/* Unicode --> CP855 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A4, 0x00CF, 0x00A7, 0x00FD, 0x00AB, 0x00AE,	0x00AD, 0x00F0, 0x00BB, 0x00AF, 0x0401, 0x0085, 0x0402, 0x0081,
+	0x0403, 0x0083, 0x0404, 0x0087, 0x0405, 0x0089, 0x0406, 0x008B,	0x0407, 0x008D, 0x0408, 0x008F, 0x0409, 0x0091, 0x040A, 0x0093,
+	0x040B, 0x0095, 0x040C, 0x0097, 0x040E, 0x0099, 0x040F, 0x009B,	0x0410, 0x00A1, 0x0411, 0x00A3, 0x0412, 0x00EC, 0x0413, 0x00AD,
+	0x0414, 0x00A7, 0x0415, 0x00A9, 0x0416, 0x00EA, 0x0417, 0x00F4,	0x0418, 0x00B8, 0x0419, 0x00BE, 0x041A, 0x00C7, 0x041B, 0x00D1,
+	0x041C, 0x00D3, 0x041D, 0x00D5, 0x041E, 0x00D7, 0x041F, 0x00DD,	0x0420, 0x00E2, 0x0421, 0x00E4, 0x0422, 0x00E6, 0x0423, 0x00E8,
+	0x0424, 0x00AB, 0x0425, 0x00B6, 0x0426, 0x00A5, 0x0427, 0x00FC,	0x0428, 0x00F6, 0x0429, 0x00FA, 0x042A, 0x009F, 0x042B, 0x00F2,
+	0x042C, 0x00EE, 0x042D, 0x00F8, 0x042E, 0x009D, 0x042F, 0x00E0,	0x0430, 0x00A0, 0x0431, 0x00A2, 0x0432, 0x00EB, 0x0433, 0x00AC,
+	0x0434, 0x00A6, 0x0435, 0x00A8, 0x0436, 0x00E9, 0x0437, 0x00F3,	0x0438, 0x00B7, 0x0439, 0x00BD, 0x043A, 0x00C6, 0x043B, 0x00D0,
+	0x043C, 0x00D2, 0x043D, 0x00D4, 0x043E, 0x00D6, 0x043F, 0x00D8,	0x0440, 0x00E1, 0x0441, 0x00E3, 0x0442, 0x00E5, 0x0443, 0x00E7,
+	0x0444, 0x00AA, 0x0445, 0x00B5, 0x0446, 0x00A4, 0x0447, 0x00FB,	0x0448, 0x00F5, 0x0449, 0x00F9, 0x044A, 0x009E, 0x044B, 0x00F1,
+	0x044C, 0x00ED, 0x044D, 0x00F7, 0x044E, 0x009C, 0x044F, 0x00DE,	0x0451, 0x0084, 0x0452, 0x0080, 0x0453, 0x0082, 0x0454, 0x0086,
+	0x0455, 0x0088, 0x0456, 0x008A, 0x0457, 0x008C, 0x0458, 0x008E,	0x0459, 0x0090, 0x045A, 0x0092, 0x045B, 0x0094, 0x045C, 0x0096,
+	0x045E, 0x0098, 0x045F, 0x009A, 0x2116, 0x00EF, 0x2500, 0x00C4,	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,
+	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,
+	0x2554, 0x00C9, 0x2557, 0x00BB, 0x255A, 0x00C8, 0x255D, 0x00BC,	0x2560, 0x00CC, 0x2563, 0x00B9, 0x2566, 0x00CB, 0x2569, 0x00CA,
+	0x256C, 0x00CE, 0x2580, 0x00DF, 0x2584, 0x00DC, 0x2588, 0x00DB,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 857 || FF_CODE_PAGE == 0
 static
 const WCHAR uc857[] PROGMEM = {	/*  CP857(Turkish) to Unicode conversion table */
@@ -15135,6 +15309,27 @@ const WCHAR uc857[] PROGMEM = {	/*  CP857(Turkish) to Unicode conversion table *
 	0x00AD, 0x00B1, 0x0000, 0x00BE, 0x00B6, 0x00A7, 0x00F7, 0x00B8, 0x00B0, 0x00A8, 0x00B7, 0x00B9, 0x00B3, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 857
+static
+const WCHAR uni2oem857[] PROGMEM = {	/* Unicode --> CP857 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A1, 0x00AD, 0x00A2, 0x00BD, 0x00A3, 0x009C,	0x00A4, 0x00CF, 0x00A5, 0x00BE, 0x00A6, 0x00DD, 0x00A7, 0x00F5,
+	0x00A8, 0x00F9, 0x00A9, 0x00B8, 0x00AA, 0x00D1, 0x00AB, 0x00AE,	0x00AC, 0x00AA, 0x00AD, 0x00F0, 0x00AE, 0x00A9, 0x00AF, 0x00EE,
+	0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x00FD, 0x00B3, 0x00FC,	0x00B4, 0x00EF, 0x00B5, 0x00E6, 0x00B6, 0x00F4, 0x00B7, 0x00FA,
+	0x00B8, 0x00F7, 0x00B9, 0x00FB, 0x00BA, 0x00D0, 0x00BB, 0x00AF,	0x00BC, 0x00AC, 0x00BD, 0x00AB, 0x00BE, 0x00F3, 0x00BF, 0x00A8,
+	0x00C0, 0x00B7, 0x00C1, 0x00B5, 0x00C2, 0x00B6, 0x00C3, 0x00C7,	0x00C4, 0x008E, 0x00C5, 0x008F, 0x00C6, 0x0092, 0x00C7, 0x0080,
+	0x00C8, 0x00D4, 0x00C9, 0x0090, 0x00CA, 0x00D2, 0x00CB, 0x00D3,	0x00CC, 0x00DE, 0x00CD, 0x00D6, 0x00CE, 0x00D7, 0x00CF, 0x00D8,
+	0x00D1, 0x00A5, 0x00D2, 0x00E3, 0x00D3, 0x00E0, 0x00D4, 0x00E2,	0x00D5, 0x00E5, 0x00D6, 0x0099, 0x00D7, 0x00E8, 0x00D8, 0x009D,
+	0x00D9, 0x00EB, 0x00DA, 0x00E9, 0x00DB, 0x00EA, 0x00DC, 0x009A,	0x00DF, 0x00E1, 0x00E0, 0x0085, 0x00E1, 0x00A0, 0x00E2, 0x0083,
+	0x00E3, 0x00C6, 0x00E4, 0x0084, 0x00E5, 0x0086, 0x00E6, 0x0091,	0x00E7, 0x0087, 0x00E8, 0x008A, 0x00E9, 0x0082, 0x00EA, 0x0088,
+	0x00EB, 0x0089, 0x00EC, 0x00EC, 0x00ED, 0x00A1, 0x00EE, 0x008C,	0x00EF, 0x008B, 0x00F1, 0x00A4, 0x00F2, 0x0095, 0x00F3, 0x00A2,
+	0x00F4, 0x0093, 0x00F5, 0x00E4, 0x00F6, 0x0094, 0x00F7, 0x00F6,	0x00F8, 0x009B, 0x00F9, 0x0097, 0x00FA, 0x00A3, 0x00FB, 0x0096,
+	0x00FC, 0x0081, 0x00FF, 0x00ED, 0x011E, 0x00A6, 0x011F, 0x00A7,	0x0130, 0x0098, 0x0131, 0x008D, 0x015E, 0x009E, 0x015F, 0x009F,
+	0x2500, 0x00C4, 0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF,	0x2514, 0x00C0, 0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4,
+	0x252C, 0x00C2, 0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD,	0x2551, 0x00BA, 0x2554, 0x00C9, 0x2557, 0x00BB, 0x255A, 0x00C8,
+	0x255D, 0x00BC, 0x2560, 0x00CC, 0x2563, 0x00B9, 0x2566, 0x00CB,	0x2569, 0x00CA, 0x256C, 0x00CE, 0x2580, 0x00DF, 0x2584, 0x00DC,
+	0x2588, 0x00DB, 0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2,	0x25A0, 0x00FE, 0, 0
+};
+#endif
 #if FF_CODE_PAGE == 860 || FF_CODE_PAGE == 0
 static
 const WCHAR uc860[] PROGMEM = {	/*  CP860(Portuguese) to Unicode conversion table */
@@ -15148,6 +15343,27 @@ const WCHAR uc860[] PROGMEM = {	/*  CP860(Portuguese) to Unicode conversion tabl
 	0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 860
+static
+const WCHAR uni2oem860[] PROGMEM = {	/* Unicode --> CP860 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A1, 0x00AD, 0x00A2, 0x009B, 0x00A3, 0x009C,	0x00AA, 0x00A6, 0x00AB, 0x00AE, 0x00AC, 0x00AA, 0x00B0, 0x00F8,
+	0x00B1, 0x00F1, 0x00B2, 0x00FD, 0x00B5, 0x00E6, 0x00B7, 0x00FA,	0x00BA, 0x00A7, 0x00BB, 0x00AF, 0x00BC, 0x00AC, 0x00BD, 0x00AB,
+	0x00BF, 0x00A8, 0x00C0, 0x0091, 0x00C1, 0x0086, 0x00C2, 0x008F,	0x00C3, 0x008E, 0x00C7, 0x0080, 0x00C8, 0x0092, 0x00C9, 0x0090,
+	0x00CA, 0x0089, 0x00CC, 0x0098, 0x00CD, 0x008B, 0x00D1, 0x00A5,	0x00D2, 0x00A9, 0x00D3, 0x009F, 0x00D4, 0x008C, 0x00D5, 0x0099,
+	0x00D9, 0x009D, 0x00DA, 0x0096, 0x00DC, 0x009A, 0x00DF, 0x00E1,	0x00E0, 0x0085, 0x00E1, 0x00A0, 0x00E2, 0x0083, 0x00E3, 0x0084,
+	0x00E7, 0x0087, 0x00E8, 0x008A, 0x00E9, 0x0082, 0x00EA, 0x0088,	0x00EC, 0x008D, 0x00ED, 0x00A1, 0x00F1, 0x00A4, 0x00F2, 0x0095,
+	0x00F3, 0x00A2, 0x00F4, 0x0093, 0x00F5, 0x0094, 0x00F7, 0x00F6,	0x00F9, 0x0097, 0x00FA, 0x00A3, 0x00FC, 0x0081, 0x0393, 0x00E2,
+	0x0398, 0x00E9, 0x03A3, 0x00E4, 0x03A6, 0x00E8, 0x03A9, 0x00EA,	0x03B1, 0x00E0, 0x03B4, 0x00EB, 0x03B5, 0x00EE, 0x03C0, 0x00E3,
+	0x03C3, 0x00E5, 0x03C4, 0x00E7, 0x03C6, 0x00ED, 0x207F, 0x00FC,	0x20A7, 0x009E, 0x2219, 0x00F9, 0x221A, 0x00FB, 0x221E, 0x00EC,
+	0x2229, 0x00EF, 0x2248, 0x00F7, 0x2261, 0x00F0, 0x2264, 0x00F3,	0x2265, 0x00F2, 0x2320, 0x00F4, 0x2321, 0x00F5, 0x2500, 0x00C4,
+	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,
+	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,	0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8,
+	0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00BE, 0x2559, 0x00D3,	0x255A, 0x00C8, 0x255C, 0x00BD, 0x255D, 0x00BC, 0x255E, 0x00C6,
+	0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5, 0x2562, 0x00B6,	0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2, 0x2566, 0x00CB,
+	0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA, 0x256A, 0x00D8,	0x256B, 0x00D7, 0x256C, 0x00CE, 0x2580, 0x00DF, 0x2584, 0x00DC,
+	0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE, 0x2591, 0x00B0,	0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE, 0, 0
+};
+#endif
 #if FF_CODE_PAGE == 861 || FF_CODE_PAGE == 0
 static
 const WCHAR uc861[] PROGMEM = {	/*  CP861(Icelandic) to Unicode conversion table */
@@ -15161,6 +15377,27 @@ const WCHAR uc861[] PROGMEM = {	/*  CP861(Icelandic) to Unicode conversion table
 	0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 861
+static
+const WCHAR uni2oem861[] PROGMEM = {	/* Unicode --> CP861 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A1, 0x00AD, 0x00A3, 0x009C, 0x00AB, 0x00AE,	0x00AC, 0x00AA, 0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x00FD,
+	0x00B5, 0x00E6, 0x00B7, 0x00FA, 0x00BB, 0x00AF, 0x00BC, 0x00AC,	0x00BD, 0x00AB, 0x00BF, 0x00A8, 0x00C1, 0x00A4, 0x00C4, 0x008E,
+	0x00C5, 0x008F, 0x00C6, 0x0092, 0x00C7, 0x0080, 0x00C9, 0x0090,	0x00CD, 0x00A5, 0x00D0, 0x008B, 0x00D3, 0x00A6, 0x00D6, 0x0099,
+	0x00D8, 0x009D, 0x00DA, 0x00A7, 0x00DC, 0x009A, 0x00DD, 0x0097,	0x00DE, 0x008D, 0x00DF, 0x00E1, 0x00E0, 0x0085, 0x00E1, 0x00A0,
+	0x00E2, 0x0083, 0x00E4, 0x0084, 0x00E6, 0x0086, 0x00E7, 0x0087,	0x00E8, 0x008A, 0x00E9, 0x0082, 0x00EA, 0x0088, 0x00EB, 0x0089,
+	0x00ED, 0x00A1, 0x00F0, 0x008C, 0x00F3, 0x00A2, 0x00F4, 0x0093,	0x00F6, 0x0094, 0x00F7, 0x00F6, 0x00F8, 0x009B, 0x00FA, 0x00A3,
+	0x00FB, 0x0096, 0x00FC, 0x0081, 0x00FD, 0x0098, 0x00FE, 0x0095,	0x0192, 0x009F, 0x0393, 0x00E2, 0x0398, 0x00E9, 0x03A3, 0x00E4,
+	0x03A6, 0x00E8, 0x03A9, 0x00EA, 0x03B1, 0x00E0, 0x03B4, 0x00EB,	0x03B5, 0x00EE, 0x03C0, 0x00E3, 0x03C3, 0x00E5, 0x03C4, 0x00E7,
+	0x03C6, 0x00ED, 0x207F, 0x00FC, 0x20A7, 0x009E, 0x2219, 0x00F9,	0x221A, 0x00FB, 0x221E, 0x00EC, 0x2229, 0x00EF, 0x2248, 0x00F7,
+	0x2261, 0x00F0, 0x2264, 0x00F3, 0x2265, 0x00F2, 0x2310, 0x00A9,	0x2320, 0x00F4, 0x2321, 0x00F5, 0x2500, 0x00C4, 0x2502, 0x00B3,
+	0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0, 0x2518, 0x00D9,	0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2, 0x2534, 0x00C1,
+	0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA, 0x2552, 0x00D5,	0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8, 0x2556, 0x00B7,
+	0x2557, 0x00BB, 0x2558, 0x00D4, 0x2559, 0x00D3, 0x255A, 0x00C8,	0x255B, 0x00BE, 0x255C, 0x00BD, 0x255D, 0x00BC, 0x255E, 0x00C6,
+	0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5, 0x2562, 0x00B6,	0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2, 0x2566, 0x00CB,
+	0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA, 0x256A, 0x00D8,	0x256B, 0x00D7, 0x256C, 0x00CE, 0x2580, 0x00DF, 0x2584, 0x00DC,
+	0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE, 0x2591, 0x00B0,	0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE, 0, 0
+};
+#endif
 #if FF_CODE_PAGE == 862 || FF_CODE_PAGE == 0
 static
 const WCHAR uc862[] PROGMEM = {	/*  CP862(Hebrew) to Unicode conversion table */
@@ -15174,6 +15411,28 @@ const WCHAR uc862[] PROGMEM = {	/*  CP862(Hebrew) to Unicode conversion table */
 	0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 862
+static
+const WCHAR uni2oem862[] PROGMEM = {	/* Unicode --> CP862 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A1, 0x00AD, 0x00A2, 0x009B, 0x00A3, 0x009C,	0x00A5, 0x009D, 0x00AA, 0x00A6, 0x00AB, 0x00AE, 0x00AC, 0x00AA,
+	0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x00FD, 0x00B5, 0x00E6,	0x00B7, 0x00FA, 0x00BA, 0x00A7, 0x00BB, 0x00AF, 0x00BC, 0x00AC,
+	0x00BD, 0x00AB, 0x00BF, 0x00A8, 0x00D1, 0x00A5, 0x00DF, 0x00E1,	0x00E1, 0x00A0, 0x00ED, 0x00A1, 0x00F1, 0x00A4, 0x00F3, 0x00A2,
+	0x00F7, 0x00F6, 0x00FA, 0x00A3, 0x0192, 0x009F, 0x0393, 0x00E2,	0x0398, 0x00E9, 0x03A3, 0x00E4, 0x03A6, 0x00E8, 0x03A9, 0x00EA,
+	0x03B1, 0x00E0, 0x03B4, 0x00EB, 0x03B5, 0x00EE, 0x03C0, 0x00E3,	0x03C3, 0x00E5, 0x03C4, 0x00E7, 0x03C6, 0x00ED, 0x05D0, 0x0080,
+	0x05D1, 0x0081, 0x05D2, 0x0082, 0x05D3, 0x0083, 0x05D4, 0x0084,	0x05D5, 0x0085, 0x05D6, 0x0086, 0x05D7, 0x0087, 0x05D8, 0x0088,
+	0x05D9, 0x0089, 0x05DA, 0x008A, 0x05DB, 0x008B, 0x05DC, 0x008C,	0x05DD, 0x008D, 0x05DE, 0x008E, 0x05DF, 0x008F, 0x05E0, 0x0090,
+	0x05E1, 0x0091, 0x05E2, 0x0092, 0x05E3, 0x0093, 0x05E4, 0x0094,	0x05E5, 0x0095, 0x05E6, 0x0096, 0x05E7, 0x0097, 0x05E8, 0x0098,
+	0x05E9, 0x0099, 0x05EA, 0x009A, 0x207F, 0x00FC, 0x20A7, 0x009E,	0x2219, 0x00F9, 0x221A, 0x00FB, 0x221E, 0x00EC, 0x2229, 0x00EF,
+	0x2248, 0x00F7, 0x2261, 0x00F0, 0x2264, 0x00F3, 0x2265, 0x00F2,	0x2310, 0x00A9, 0x2320, 0x00F4, 0x2321, 0x00F5, 0x2500, 0x00C4,
+	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,
+	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,	0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8,
+	0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00D4, 0x2559, 0x00D3,	0x255A, 0x00C8, 0x255B, 0x00BE, 0x255C, 0x00BD, 0x255D, 0x00BC,
+	0x255E, 0x00C6, 0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5,	0x2562, 0x00B6, 0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2,
+	0x2566, 0x00CB, 0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA,	0x256A, 0x00D8, 0x256B, 0x00D7, 0x256C, 0x00CE, 0x2580, 0x00DF,
+	0x2584, 0x00DC, 0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 863 || FF_CODE_PAGE == 0
 static
 const WCHAR uc863[] PROGMEM = {	/*  CP863(Canadian French) to Unicode conversion table */
@@ -15187,6 +15446,27 @@ const WCHAR uc863[] PROGMEM = {	/*  CP863(Canadian French) to Unicode conversion
 	0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 863
+static
+const WCHAR uni2oem863[] PROGMEM = {	/* Unicode --> CP863 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A2, 0x009B, 0x00A3, 0x009C, 0x00A4, 0x0098,	0x00A6, 0x00A0, 0x00A8, 0x00A4, 0x00AB, 0x00AE, 0x00AC, 0x00AA,
+	0x00AF, 0x00A7, 0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x00FD,	0x00B3, 0x00A6, 0x00B4, 0x00A1, 0x00B5, 0x00E6, 0x00B6, 0x0086,
+	0x00B7, 0x00FA, 0x00BB, 0x00A5, 0x00BC, 0x00AC, 0x00BD, 0x00AB,	0x00BE, 0x00AD, 0x00C0, 0x008F, 0x00C2, 0x0084, 0x00C7, 0x0080,
+	0x00C8, 0x0091, 0x00C9, 0x0090, 0x00CA, 0x0092, 0x00CB, 0x0094,	0x00CE, 0x00A8, 0x00CF, 0x0095, 0x00D4, 0x0099, 0x00D9, 0x009D,
+	0x00DB, 0x009E, 0x00DC, 0x009A, 0x00DF, 0x00E1, 0x00E0, 0x0085,	0x00E2, 0x0083, 0x00E7, 0x0087, 0x00E8, 0x008A, 0x00E9, 0x0082,
+	0x00EA, 0x0088, 0x00EB, 0x0089, 0x00EC, 0x008D, 0x00EE, 0x008C,	0x00EF, 0x008B, 0x00F3, 0x00A2, 0x00F4, 0x0093, 0x00F7, 0x00F6,
+	0x00F9, 0x0097, 0x00FA, 0x00A3, 0x00FB, 0x0096, 0x00FC, 0x0081,	0x0192, 0x009F, 0x0393, 0x00E2, 0x0398, 0x00E9, 0x03A3, 0x00E4,
+	0x03A6, 0x00E8, 0x03A9, 0x00EA, 0x03B1, 0x00E0, 0x03B4, 0x00EB,	0x03B5, 0x00EE, 0x03C0, 0x00E3, 0x03C3, 0x00E5, 0x03C4, 0x00E7,
+	0x03C6, 0x00ED, 0x2017, 0x008E, 0x207F, 0x00FC, 0x2219, 0x00EF,	0x221A, 0x00FB, 0x221E, 0x00EC, 0x2248, 0x00F7, 0x2261, 0x00F0,
+	0x2264, 0x00F3, 0x2265, 0x00F2, 0x2320, 0x00F4, 0x2321, 0x00F5,	0x2500, 0x00C4, 0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF,
+	0x2514, 0x00C0, 0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4,	0x252C, 0x00C2, 0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD,
+	0x2551, 0x00BA, 0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9,	0x2555, 0x00B8, 0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00D4,
+	0x2559, 0x00D3, 0x255A, 0x00C8, 0x255B, 0x00BE, 0x255C, 0x00BD,	0x255D, 0x00BC, 0x255E, 0x00C6, 0x255F, 0x00C7, 0x2560, 0x00CC,
+	0x2561, 0x00B5, 0x2562, 0x00B6, 0x2563, 0x00B9, 0x2564, 0x00D1,	0x2565, 0x00D2, 0x2566, 0x00CB, 0x2567, 0x00CF, 0x2568, 0x00D0,
+	0x2569, 0x00CA, 0x256A, 0x00D8, 0x256B, 0x00D7, 0x256C, 0x00CE,	0x2580, 0x00DF, 0x2584, 0x00DC, 0x2588, 0x00DB, 0x258C, 0x00DD,
+	0x2590, 0x00DE, 0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2,	0x25A0, 0x00FE, 0x3210, 0x00A9, 0, 0
+};
+#endif
 #if FF_CODE_PAGE == 864 || FF_CODE_PAGE == 0
 static
 const WCHAR uc864[] PROGMEM = {	/*  CP864(Arabic) to Unicode conversion table */
@@ -15200,6 +15480,27 @@ const WCHAR uc864[] PROGMEM = {	/*  CP864(Arabic) to Unicode conversion table */
 	0xFE7D, 0x0651, 0xFEE5, 0xFEE9, 0xFEEC, 0xFEF0, 0xFEF2, 0xFED0, 0xFED5, 0xFEF5, 0xFEF6, 0xFEDD, 0xFED9, 0xFEF1, 0x25A0, 0x0000
 };
 #endif
+#if FF_CODE_PAGE == 864
+static
+const WCHAR uni2oem864[] PROGMEM = {	/* Unicode --> CP864 pairs, for the static code page configuration */
+	0x00A0, 0x00A0, 0x00A2, 0x00C0, 0x00A3, 0x00A3, 0x00A4, 0x00A4,	0x00A6, 0x00DB, 0x00AB, 0x0097, 0x00AC, 0x00DC, 0x00AD, 0x00A1,
+	0x00B0, 0x0080, 0x00B1, 0x0093, 0x00B7, 0x0081, 0x00BB, 0x0098,	0x00BC, 0x0095, 0x00BD, 0x0094, 0x00D7, 0x00DE, 0x00F7, 0x00DD,
+	0x03B2, 0x0090, 0x03C6, 0x0092, 0x060C, 0x00AC, 0x061B, 0x00BB,	0x061F, 0x00BF, 0x0640, 0x00E0, 0x0651, 0x00F1, 0x0660, 0x00B0,
+	0x0661, 0x00B1, 0x0662, 0x00B2, 0x0663, 0x00B3, 0x0664, 0x00B4,	0x0665, 0x00B5, 0x0666, 0x00B6, 0x0667, 0x00B7, 0x0668, 0x00B8,
+	0x0669, 0x00B9, 0x20AC, 0x00A7, 0x2219, 0x0082, 0x221A, 0x0083,	0x221E, 0x0091, 0x2248, 0x0096, 0x2500, 0x0085, 0x2502, 0x0086,
+	0x250C, 0x008D, 0x2510, 0x008C, 0x2514, 0x008E, 0x2518, 0x008F,	0x251C, 0x008A, 0x2524, 0x0088, 0x252C, 0x0089, 0x2534, 0x008B,
+	0x253C, 0x0087, 0x2592, 0x0084, 0x25A0, 0x00FE, 0xFE7D, 0x00F0,	0xFE80, 0x00C1, 0xFE81, 0x00C2, 0xFE82, 0x00A2, 0xFE83, 0x00C3,
+	0xFE84, 0x00A5, 0xFE85, 0x00C4, 0xFE8B, 0x00C6, 0xFE8D, 0x00C7,	0xFE8E, 0x00A8, 0xFE8F, 0x00A9, 0xFE91, 0x00C8, 0xFE93, 0x00C9,
+	0xFE95, 0x00AA, 0xFE97, 0x00CA, 0xFE99, 0x00AB, 0xFE9B, 0x00CB,	0xFE9D, 0x00AD, 0xFE9F, 0x00CC, 0xFEA1, 0x00AE, 0xFEA3, 0x00CD,
+	0xFEA5, 0x00AF, 0xFEA7, 0x00CE, 0xFEA9, 0x00CF, 0xFEAB, 0x00D0,	0xFEAD, 0x00D1, 0xFEAF, 0x00D2, 0xFEB1, 0x00BC, 0xFEB3, 0x00D3,
+	0xFEB5, 0x00BD, 0xFEB7, 0x00D4, 0xFEB9, 0x00BE, 0xFEBB, 0x00D5,	0xFEBD, 0x00EB, 0xFEBF, 0x00D6, 0xFEC1, 0x00D7, 0xFEC5, 0x00D8,
+	0xFEC9, 0x00DF, 0xFECA, 0x00C5, 0xFECB, 0x00D9, 0xFECC, 0x00EC,	0xFECD, 0x00EE, 0xFECE, 0x00ED, 0xFECF, 0x00DA, 0xFED0, 0x00F7,
+	0xFED1, 0x00BA, 0xFED3, 0x00E1, 0xFED5, 0x00F8, 0xFED7, 0x00E2,	0xFED9, 0x00FC, 0xFEDB, 0x00E3, 0xFEDD, 0x00FB, 0xFEDF, 0x00E4,
+	0xFEE1, 0x00EF, 0xFEE3, 0x00E5, 0xFEE5, 0x00F2, 0xFEE7, 0x00E6,	0xFEE9, 0x00F3, 0xFEEB, 0x00E7, 0xFEEC, 0x00F4, 0xFEED, 0x00E8,
+	0xFEEF, 0x00E9, 0xFEF0, 0x00F5, 0xFEF1, 0x00FD, 0xFEF2, 0x00F6,	0xFEF3, 0x00EA, 0xFEF5, 0x00F9, 0xFEF6, 0x00FA, 0xFEF7, 0x0099,
+	0xFEF8, 0x009A, 0xFEFB, 0x009D, 0xFEFC, 0x009E, 0, 0
+};
+#endif
 #if FF_CODE_PAGE == 865 || FF_CODE_PAGE == 0
 static
 const WCHAR uc865[] PROGMEM = {	/*  CP865(Nordic) to Unicode conversion table */
@@ -15213,6 +15514,27 @@ const WCHAR uc865[] PROGMEM = {	/*  CP865(Nordic) to Unicode conversion table */
 	0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 865
+static
+const WCHAR uni2oem865[] PROGMEM = {	/* Unicode --> CP865 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A1, 0x00AD, 0x00A3, 0x009C, 0x00A4, 0x00AF,	0x00AA, 0x00A6, 0x00AB, 0x00AE, 0x00AC, 0x00AA, 0x00B0, 0x00F8,
+	0x00B1, 0x00F1, 0x00B2, 0x00FD, 0x00B5, 0x00E6, 0x00B7, 0x00FA,	0x00BA, 0x00A7, 0x00BC, 0x00AC, 0x00BD, 0x00AB, 0x00BF, 0x00A8,
+	0x00C4, 0x008E, 0x00C5, 0x008F, 0x00C6, 0x0092, 0x00C7, 0x0080,	0x00D1, 0x00A5, 0x00D6, 0x0099, 0x00D8, 0x009D, 0x00DC, 0x009A,
+	0x00DF, 0x00E1, 0x00E0, 0x0085, 0x00E1, 0x00A0, 0x00E2, 0x0083,	0x00E4, 0x0084, 0x00E5, 0x0086, 0x00E6, 0x0091, 0x00E7, 0x0087,
+	0x00E8, 0x008A, 0x00E9, 0x0082, 0x00EA, 0x0088, 0x00EB, 0x0089,	0x00EC, 0x008D, 0x00ED, 0x00A1, 0x00EE, 0x008C, 0x00EF, 0x008B,
+	0x00F1, 0x00A4, 0x00F2, 0x0095, 0x00F3, 0x00A2, 0x00F4, 0x0093,	0x00F6, 0x0094, 0x00F7, 0x00F6, 0x00F8, 0x009B, 0x00F9, 0x0097,
+	0x00FA, 0x00A3, 0x00FB, 0x0096, 0x00FC, 0x0081, 0x00FF, 0x0098,	0x0192, 0x009F, 0x0393, 0x00E2, 0x0398, 0x00E9, 0x03A3, 0x00E4,
+	0x03A6, 0x00E8, 0x03A9, 0x00EA, 0x03B1, 0x00E0, 0x03B4, 0x00EB,	0x03B5, 0x00EE, 0x03C0, 0x00E3, 0x03C3, 0x00E5, 0x03C4, 0x00E7,
+	0x03C6, 0x00ED, 0x207F, 0x00FC, 0x20A7, 0x009E, 0x2219, 0x00F9,	0x221A, 0x00FB, 0x221E, 0x00EC, 0x2229, 0x00EF, 0x2248, 0x00F7,
+	0x2261, 0x00F0, 0x2264, 0x00F3, 0x2265, 0x00F2, 0x2310, 0x00A9,	0x2320, 0x00F4, 0x2321, 0x00F5, 0x2500, 0x00C4, 0x2502, 0x00B3,
+	0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0, 0x2518, 0x00D9,	0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2, 0x2534, 0x00C1,
+	0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA, 0x2552, 0x00D5,	0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8, 0x2556, 0x00B7,
+	0x2557, 0x00BB, 0x2558, 0x00BE, 0x2559, 0x00D3, 0x255A, 0x00C8,	0x255C, 0x00BD, 0x255D, 0x00BC, 0x255E, 0x00C6, 0x255F, 0x00C7,
+	0x2560, 0x00CC, 0x2561, 0x00B5, 0x2562, 0x00B6, 0x2563, 0x00B9,	0x2564, 0x00D1, 0x2565, 0x00D2, 0x2566, 0x00CB, 0x2567, 0x00CF,
+	0x2568, 0x00D0, 0x2569, 0x00CA, 0x256A, 0x00D8, 0x256B, 0x00D7,	0x256C, 0x00CE, 0x2580, 0x00DF, 0x2584, 0x00DC, 0x2588, 0x00DB,
+	0x258C, 0x00DD, 0x2590, 0x00DE, 0x2591, 0x00B0, 0x2592, 0x00B1,	0x2593, 0x00B2, 0x25A0, 0x00FE, 0, 0
+};
+#endif
 #if FF_CODE_PAGE == 866 || FF_CODE_PAGE == 0
 static
 const WCHAR uc866[] PROGMEM = {	/*  CP866(Russian) to Unicode conversion table */
@@ -15226,6 +15548,28 @@ const WCHAR uc866[] PROGMEM = {	/*  CP866(Russian) to Unicode conversion table *
 	0x0401, 0x0451, 0x0404, 0x0454, 0x0407, 0x0457, 0x040E, 0x045E, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x2116, 0x00A4, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 866
+static
+const WCHAR uni2oem866[] PROGMEM = {	/* Unicode --> CP866 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A4, 0x00FD, 0x00B0, 0x00F8, 0x00B7, 0x00FA,	0x0401, 0x00F0, 0x0404, 0x00F2, 0x0407, 0x00F4, 0x040E, 0x00F6,
+	0x0410, 0x0080, 0x0411, 0x0081, 0x0412, 0x0082, 0x0413, 0x0083,	0x0414, 0x0084, 0x0415, 0x0085, 0x0416, 0x0086, 0x0417, 0x0087,
+	0x0418, 0x0088, 0x0419, 0x0089, 0x041A, 0x008A, 0x041B, 0x008B,	0x041C, 0x008C, 0x041D, 0x008D, 0x041E, 0x008E, 0x041F, 0x008F,
+	0x0420, 0x0090, 0x0421, 0x0091, 0x0422, 0x0092, 0x0423, 0x0093,	0x0424, 0x0094, 0x0425, 0x0095, 0x0426, 0x0096, 0x0427, 0x0097,
+	0x0428, 0x0098, 0x0429, 0x0099, 0x042A, 0x009A, 0x042B, 0x009B,	0x042C, 0x009C, 0x042D, 0x009D, 0x042E, 0x009E, 0x042F, 0x009F,
+	0x0430, 0x00A0, 0x0431, 0x00A1, 0x0432, 0x00A2, 0x0433, 0x00A3,	0x0434, 0x00A4, 0x0435, 0x00A5, 0x0436, 0x00A6, 0x0437, 0x00A7,
+	0x0438, 0x00A8, 0x0439, 0x00A9, 0x043A, 0x00AA, 0x043B, 0x00AB,	0x043C, 0x00AC, 0x043D, 0x00AD, 0x043E, 0x00AE, 0x043F, 0x00AF,
+	0x0440, 0x00E0, 0x0441, 0x00E1, 0x0442, 0x00E2, 0x0443, 0x00E3,	0x0444, 0x00E4, 0x0445, 0x00E5, 0x0446, 0x00E6, 0x0447, 0x00E7,
+	0x0448, 0x00E8, 0x0449, 0x00E9, 0x044A, 0x00EA, 0x044B, 0x00EB,	0x044C, 0x00EC, 0x044D, 0x00ED, 0x044E, 0x00EE, 0x044F, 0x00EF,
+	0x0451, 0x00F1, 0x0454, 0x00F3, 0x0457, 0x00F5, 0x045E, 0x00F7,	0x2116, 0x00FC, 0x2219, 0x00F9, 0x221A, 0x00FB, 0x2500, 0x00C4,
+	0x2502, 0x00B3, 0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0,	0x2518, 0x00D9, 0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2,
+	0x2534, 0x00C1, 0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA,	0x2552, 0x00D5, 0x2553, 0x00D6, 0x2554, 0x00C9, 0x2555, 0x00B8,
+	0x2556, 0x00B7, 0x2557, 0x00BB, 0x2558, 0x00D4, 0x2559, 0x00D3,	0x255A, 0x00C8, 0x255B, 0x00BE, 0x255C, 0x00BD, 0x255D, 0x00BC,
+	0x255E, 0x00C6, 0x255F, 0x00C7, 0x2560, 0x00CC, 0x2561, 0x00B5,	0x2562, 0x00B6, 0x2563, 0x00B9, 0x2564, 0x00D1, 0x2565, 0x00D2,
+	0x2566, 0x00CB, 0x2567, 0x00CF, 0x2568, 0x00D0, 0x2569, 0x00CA,	0x256A, 0x00D8, 0x256B, 0x00D7, 0x256C, 0x00CE, 0x2580, 0x00DF,
+	0x2584, 0x00DC, 0x2588, 0x00DB, 0x258C, 0x00DD, 0x2590, 0x00DE,	0x2591, 0x00B0, 0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE,
+	0, 0
+};
+#endif
 #if FF_CODE_PAGE == 869 || FF_CODE_PAGE == 0
 static
 const WCHAR uc869[] PROGMEM = {	/*  CP869(Greek 2) to Unicode conversion table */
@@ -15239,6 +15583,26 @@ const WCHAR uc869[] PROGMEM = {	/*  CP869(Greek 2) to Unicode conversion table *
 	0x00AD, 0x00B1, 0x03C5, 0x03C6, 0x03C7, 0x00A7, 0x03C8, 0x0385, 0x00B0, 0x00A8, 0x03C9, 0x03CB, 0x03B0, 0x03CE, 0x25A0, 0x00A0
 };
 #endif
+#if FF_CODE_PAGE == 869
+static
+const WCHAR uni2oem869[] PROGMEM = {	/* Unicode --> CP869 pairs, for the static code page configuration */
+	0x00A0, 0x00FF, 0x00A3, 0x009C, 0x00A6, 0x008A, 0x00A7, 0x00F5,	0x00A8, 0x00F9, 0x00A9, 0x0097, 0x00AB, 0x00AE, 0x00AC, 0x0089,
+	0x00AD, 0x00F0, 0x00B0, 0x00F8, 0x00B1, 0x00F1, 0x00B2, 0x0099,	0x00B3, 0x009A, 0x00B7, 0x0080, 0x00BB, 0x00AF, 0x00BD, 0x00AB,
+	0x0384, 0x00EF, 0x0385, 0x00F7, 0x0386, 0x0086, 0x0388, 0x008D,	0x0389, 0x008F, 0x038A, 0x0090, 0x038C, 0x0092, 0x038E, 0x0095,
+	0x038F, 0x0098, 0x0390, 0x00A1, 0x0391, 0x00A4, 0x0392, 0x00A5,	0x0393, 0x00A6, 0x0394, 0x00A7, 0x0395, 0x00A8, 0x0396, 0x00A9,
+	0x0397, 0x00AA, 0x0398, 0x00AC, 0x0399, 0x00AD, 0x039A, 0x00B5,	0x039B, 0x00B6, 0x039C, 0x00B7, 0x039D, 0x00B8, 0x039E, 0x00BD,
+	0x039F, 0x00BE, 0x03A1, 0x00C7, 0x03A3, 0x00CF, 0x03A4, 0x00D0,	0x03A5, 0x00D1, 0x03A6, 0x00D2, 0x03A7, 0x00D3, 0x03A8, 0x00D4,
+	0x03A9, 0x00D5, 0x03AA, 0x0091, 0x03AB, 0x0096, 0x03AC, 0x009B,	0x03AD, 0x009D, 0x03AE, 0x009E, 0x03AF, 0x009F, 0x03B0, 0x00FC,
+	0x03B1, 0x00D6, 0x03B2, 0x00D7, 0x03B3, 0x00D8, 0x03B4, 0x00DD,	0x03B5, 0x00DE, 0x03B6, 0x00E0, 0x03B7, 0x00E1, 0x03B8, 0x00E2,
+	0x03B9, 0x00E3, 0x03BA, 0x00E4, 0x03BB, 0x00E5, 0x03BC, 0x00E6,	0x03BD, 0x00E7, 0x03BE, 0x00E8, 0x03BF, 0x00E9, 0x03C0, 0x00EA,
+	0x03C1, 0x00EB, 0x03C2, 0x00ED, 0x03C3, 0x00EC, 0x03C4, 0x00EE,	0x03C5, 0x00F2, 0x03C6, 0x00F3, 0x03C7, 0x00F4, 0x03C8, 0x00F6,
+	0x03C9, 0x00FA, 0x03CA, 0x00A0, 0x03CB, 0x00FB, 0x03CC, 0x00A2,	0x03CD, 0x00A3, 0x03CE, 0x00FD, 0x0A30, 0x00C6, 0x2015, 0x008E,
+	0x2018, 0x008B, 0x2019, 0x008C, 0x2500, 0x00C4, 0x2502, 0x00B3,	0x250C, 0x00DA, 0x2510, 0x00BF, 0x2514, 0x00C0, 0x2518, 0x00D9,
+	0x251C, 0x00C3, 0x2524, 0x00B4, 0x252C, 0x00C2, 0x2534, 0x00C1,	0x253C, 0x00C5, 0x2550, 0x00CD, 0x2551, 0x00BA, 0x2554, 0x00C9,
+	0x2557, 0x00BB, 0x255A, 0x00C8, 0x255D, 0x00BC, 0x2560, 0x00CC,	0x2563, 0x00B9, 0x2566, 0x00CB, 0x2569, 0x00CA, 0x256C, 0x00CE,
+	0x2580, 0x00DF, 0x2584, 0x00DC, 0x2588, 0x00DB, 0x2591, 0x00B0,	0x2592, 0x00B1, 0x2593, 0x00B2, 0x25A0, 0x00FE, 0, 0
+};
+#endif
 
 
 
@@ -15254,8 +15618,9 @@ WCHAR ff_uni2oem (	/* Returns OEM code character, zero on error */
 	WORD	cp		/* Code page for the conversion */
 )
 {
-	WCHAR c = 0;
-	const WCHAR *p = CVTBL(uc, FF_CODE_PAGE);
+	const WCHAR *p;
+	WCHAR c = 0, uc;
+	UINT i, n, li, hi;
 
 
 	if (uni < 0x80) {	/* ASCII? */
@@ -15263,8 +15628,20 @@ WCHAR ff_uni2oem (	/* Returns OEM code character, zero on error */
 
 	} else {			/* Non-ASCII */
 		if (uni < 0x10000 && cp == FF_CODE_PAGE) {	/* Is it a valid code? */
-			for (c = 0; c < 0x80 && uni != pgm_read_word_inlined(p+c); c++) ;
-			c = (c + 0x80) & 0xFF;
+			uc = (WCHAR)uni;
+			p = CVTBL(uni2oem, FF_CODE_PAGE);	/* Search the sorted pairs instead of the OEM order table */
+			hi = sizeof CVTBL(uni2oem, FF_CODE_PAGE) / 4 - 1;
+			li = 0;
+			for (n = 8; n; n--) {
+				i = li + (hi - li) / 2;
+				if (uc == pgm_read_word_inlined(p+(i * 2))) break;
+				if (uc > pgm_read_word_inlined(p+(i * 2))) {
+					li = i;
+				} else {
+					hi = i;
+				}
+			}
+			if (n != 0) c = pgm_read_word_inlined(p+(i * 2 + 1));
 		}
 	}
 
@@ -128,6 +128,48 @@ extern "C" uint32_t _SPIFFS_end;
 #define VFATFS_PHYS_SIZE	\
 	((uint32_t)&_SPIFFS_end - (uint32_t)&_SPIFFS_start)
 
+#if defined(VFATFS_TRIMCACHE) && VFATFS_TCSTORE
+	// Last sector is reserved for storing trim cache
+	#define VFATFS_DISK_SECTORS	(VFATFS_PHYS_SIZE/VFATFS_SECTOR_SIZE - 1)
+#else
+	#define VFATFS_DISK_SECTORS	(VFATFS_PHYS_SIZE/VFATFS_SECTOR_SIZE)
+#endif
+
+#define SECT_PAGES_ALL	((uint16_t)((1UL << VFATFS_SECT_PAGES) - 1))
+
+#if VFATFS_CONSERVE_LEVEL >= 1
+// Set while serving append-mode file, whose writes mostly only clear bits
+static bool AppendWrite = false;
+#endif
+
+#if VFATFS_BLOCK_ERASE
+
+#define ERASE_BLOCK_SIZE	0x10000
+#define ERASE_BLOCK_SECTS	(ERASE_BLOCK_SIZE/VFATFS_SECTOR_SIZE)
+
+extern "C" void Cache_Read_Disable_2(void);
+extern "C" void Cache_Read_Enable_2(void);
+extern "C" int SPIUnlock(void);
+extern "C" int SPIEraseBlock(uint32_t block);
+
+// SDK only offers sector erase, so use ROM routine the same way it does
+// The symbols are resolved by the ROM address linker script of the SDK
+// Unlike spi_flash_erase_sector(), nothing waits for SPI idle or checks protected areas
+static int ICACHE_RAM_ATTR FlashEraseBlock(uint16_t block) {
+	Cache_Read_Disable_2();
+	int ret = SPIUnlock();
+	if (!ret) ret = SPIEraseBlock(block);
+	Cache_Read_Enable_2();
+	return ret;
+}
+
+// Whether a run of count sectors covers an erase block from given sector
+#define BLOCK_ERASABLE(sector, count)	\
+	(!((VFATFS_PHYS_ADDR/VFATFS_SECTOR_SIZE+(sector)) % ERASE_BLOCK_SECTS) &&	\
+		((count) >= ERASE_BLOCK_SECTS))
+
+#endif
+
 #ifdef VFATFS_TRIMCACHE
 
 	// Layer 0: Trimmed; Layer 1: Seen
@@ -161,15 +203,101 @@ extern "C" uint32_t _SPIFFS_end;
 		else return L1? PSTR_L("dirty") : PSTR_L("unknown");
 	}
 
+	#if VFATFS_TCSTORE
+
+	#define TCSTORE_SECTOR	(VFATFS_PHYS_SIZE/VFATFS_SECTOR_SIZE - 1)
+	#define TCSTORE_MAGIC	0x43544656	// "VFTC"
+	#define TCSTORE_VALID	0x4B4F5443	// "CTOK"
+
+	typedef struct {
+		uint32_t magic;
+		uint16_t sectors;	// Number of sectors covered
+		uint16_t layers;	// Number of bitmap layers
+		uint32_t checksum;	// Of the bitmap layers
+		uint32_t valid;		// Cleared once consumed
+	} TCStoreHeader;
+
+	static bool TCStored = false;
+
+	static uint32_t TrimCacheChecksum(const uint32_t* data, size_t size) {
+		uint32_t sum = 0;
+		for (size /= 4; size; size--)
+			sum = (sum << 1 | sum >> 31) + *data++;
+		return sum;
+	}
+
+	// Invalidate the stored trim cache, since it is going to diverge
+	static void TrimCacheConsume() {
+		uint32_t addr = VFATFS_PHYS_ADDR + TCSTORE_SECTOR * VFATFS_SECTOR_SIZE;
+		uint32_t valid = 0;
+		if (spi_flash_write(addr + offsetof(TCStoreHeader, valid), &valid, 4) != 0) {
+			ESPFAT_DEBUG("[VFATFS] Failed to invalidate stored trim cache!\n");
+		}
+		TCStored = false;
+	}
+
+	static void TrimCacheLoad(uint16_t sectCnt, BYTE* data, size_t size) {
+		uint32_t addr = VFATFS_PHYS_ADDR + TCSTORE_SECTOR * VFATFS_SECTOR_SIZE;
+		TCStoreHeader header;
+		if (spi_flash_read(addr, (uint32_t*)&header, sizeof(header)) != 0) {
+			ESPFAT_DEBUG("[VFATFS] Failed to read stored trim cache!\n");
+			return;
+		}
+		if (header.magic != TCSTORE_MAGIC || header.valid != TCSTORE_VALID) {
+			ESPFAT_DEBUGV("[VFATFS] No stored trim cache\n");
+			return;
+		}
+		// Stored copy is only trusted once
+		TrimCacheConsume();
+		if (header.sectors != sectCnt || header.layers != TRIMCACHE_LAYERS) {
+			ESPFAT_DEBUGV("[VFATFS] Stored trim cache mismatch\n");
+			return;
+		}
+		if (spi_flash_read(addr + sizeof(header), (uint32_t*)data, size) != 0 ||
+			TrimCacheChecksum((uint32_t*)data, size) != header.checksum) {
+			ESPFAT_DEBUG("[VFATFS] Stored trim cache corrupted!\n");
+			memset(data, 0, size);
+			return;
+		}
+		ESPFAT_DEBUGV("[VFATFS] Restored trim cache\n");
+	}
+
+	static void TrimCacheSave() {
+		if (!TCLayer[0] || TCStored) return;
+		uint16_t sectCnt = VFATFS_PHYS_SIZE / VFATFS_SECTOR_SIZE;
+		uint16_t mapSize = 4*((sectCnt+31) / 32);
+		uint32_t addr = VFATFS_PHYS_ADDR + TCSTORE_SECTOR * VFATFS_SECTOR_SIZE;
+		TCStoreHeader header = { TCSTORE_MAGIC, sectCnt, TRIMCACHE_LAYERS,
+			TrimCacheChecksum((uint32_t*)TCLayer[0], TRIMCACHE_LAYERS*mapSize),
+			TCSTORE_VALID };
+
+		ESPFAT_DEBUGVV("[VFATFS] E #%d\n", TCSTORE_SECTOR);
+		if (spi_flash_erase_sector(addr / VFATFS_SECTOR_SIZE) != 0 ||
+			spi_flash_write(addr + sizeof(header), (uint32_t*)TCLayer[0],
+				TRIMCACHE_LAYERS*mapSize) != 0 ||
+			// Header goes last, so partial store is never valid
+			spi_flash_write(addr, (uint32_t*)&header, sizeof(header)) != 0) {
+			ESPFAT_DEBUG("[VFATFS] Failed to store trim cache!\n");
+			return;
+		}
+		ESPFAT_DEBUGV("[VFATFS] Stored trim cache\n");
+		TCStored = true;
+	}
+
+	#endif
+
 	static void TrimCacheInit() {
 		if (!TCLayer[0]) {
 			uint16_t sectCnt = VFATFS_PHYS_SIZE / VFATFS_SECTOR_SIZE;
-			uint16_t mapSize = 2*((sectCnt+15) / 16);
+			uint16_t mapSize = 4*((sectCnt+31) / 32);
 			ESPFAT_DEBUGV("[VFATFS] %d sectors, TrimCache[#%d]\n",
 				sectCnt, TRIMCACHE_LAYERS*mapSize);
 			BYTE* TRIMCACHE = (BYTE*) malloc(TRIMCACHE_LAYERS*mapSize);
 			if (TRIMCACHE) {
 				memset(TRIMCACHE, 0, TRIMCACHE_LAYERS*mapSize);
+	#if VFATFS_TCSTORE
+				TrimCacheLoad(sectCnt, TRIMCACHE, TRIMCACHE_LAYERS*mapSize);
+	#endif
 				TCLayer[0] = (uint16_t*)TRIMCACHE;
 	#if VFATFS_CONSERVE_LEVEL >= 1
 				TCLayer[1] = (uint16_t*)(TRIMCACHE+mapSize);
@@ -182,6 +310,9 @@ extern "C" uint32_t _SPIFFS_end;
 				ESPFAT_DEBUG("[VFATFS] Failed to allocate trim cache!\n");
 			}
 		}
+	#if VFATFS_TCSTORE
+		else if (TCStored) TrimCacheConsume();
+	#endif
 	}
 
 	#if VFATFS_CONSERVE_LEVEL >= 1
@@ -208,6 +339,34 @@ extern "C" uint32_t _SPIFFS_end;
 		return !size;
 	}
 
+	// Returns: 0 - identical; >0 - only clears bits; <0 - need erase
+	// Only given pages are compared, and narrowed down to those differ
+	static int8_t CompareSector(uint16_t sector, const uint32_t* data,
+		uint16_t& pages) {
+		uint32_t ProbeData[VFATFS_PROBE_UNIT/4];
+		uint32_t addr = VFATFS_PHYS_ADDR + sector * VFATFS_SECTOR_SIZE;
+		uint16_t diffpages = 0;
+
+		for (size_t ofs = 0; ofs < VFATFS_SECTOR_SIZE; ofs+= VFATFS_PROBE_UNIT) {
+			uint16_t page = 1 << (ofs / VFATFS_PAGE_SIZE);
+			if (!(pages & page)) continue;
+			int ret = spi_flash_read(addr+ofs, (uint32_t*)ProbeData, VFATFS_PROBE_UNIT);
+			if (ret != 0) {
+				ESPFAT_DEBUG("[VFATFS] Sector #%d compare failed!\n", sector);
+				return -1;
+			}
+			const uint32_t* cur = data + ofs/4;
+			for (ret = 0; ret < VFATFS_PROBE_UNIT/4; ret++) {
+				if (ProbeData[ret] == cur[ret]) continue;
+				// Programming can only turn 1 bits to 0
+				if ((ProbeData[ret] & cur[ret]) != cur[ret]) return -1;
+				diffpages |= page;
+			}
+		}
+		pages = diffpages;
+		return diffpages? 1 : 0;
+	}
+
 		#if VFATFS_BGTRIM_INTERVAL
 
 		static void BackgroundTrim(void *arg) {
@@ -218,6 +377,25 @@ extern "C" uint32_t _SPIFFS_end;
 			uint16_t erase_base = VFATFS_PHYS_ADDR/VFATFS_SECTOR_SIZE;
 			uint16_t sector = bgidx*16;
 
+	#if VFATFS_BLOCK_ERASE
+			// Whole block scheduled for erase, do it at once
+			if (BLOCK_ERASABLE(sector, VFATFS_PHYS_SIZE/VFATFS_SECTOR_SIZE-sector) &&
+				L0States == 0xFFFF && !L1States) {
+				ESPFAT_DEBUGVV("[VFATFS] E #%d (%d)\n", sector, ERASE_BLOCK_SECTS);
+				int ret = FlashEraseBlock((erase_base+sector)/ERASE_BLOCK_SECTS);
+				if (ret != 0) {
+					ESPFAT_DEBUG("[VFATFS] Erase of #%d (%d) failed!\n",
+						sector, ERASE_BLOCK_SECTS);
+				} else {
+					// Mark as seen
+					TCLayer[1][bgidx] = 0xFFFF;
+					bgidx++;
+					system_soft_wdt_feed();
+					return;
+				}
+			}
+	#endif
+
 			int count = 0;
 			uint16_t bitIdx = 1;
 			while (bitIdx) {
@@ -303,6 +481,8 @@ extern "C" uint32_t _SPIFFS_end;
 		}
 
 	#if VFATFS_CONSERVE_LEVEL >= 1
+		// For pre-read: caller reads the data anyway, and reports back
+		if (intent < 0) return false;
 		// Mark as seen
 		TCLayer[1][wordIdx] |= bitIdx;
 		// Probe sector data
@@ -314,6 +494,62 @@ extern "C" uint32_t _SPIFFS_end;
 	#endif
 	}
 
+	#if VFATFS_CONSERVE_LEVEL >= 1
+
+	// Learn state of an unseen sector from its data, read by the caller
+	static void TrimCacheProbed(uint16_t sector, const uint32_t* data) {
+		if (!TCLayer[0]) return;
+		uint16_t wordIdx = sector / 16;
+		uint16_t bitIdx = 1 << (sector % 16);
+		if (TCLayer[1][wordIdx]&bitIdx) return;
+
+		int ret = VFATFS_SECTOR_SIZE/4;
+		while (ret--) if (data[ret]+1) break;
+		ESPFAT_DEBUGVV("[VFATFS] TrimCache[%d] -> %s\n", sector,
+			SFPSTR(TCStateToStr(ret < 0, true)));
+		// Mark as seen, and clean if so
+		TCLayer[1][wordIdx] |= bitIdx;
+		if (ret < 0) TCLayer[0][wordIdx] |= bitIdx;
+	}
+
+	#endif
+
+	#if VFATFS_BLOCK_ERASE
+
+	// Erase the block starting from sector, unless any is known clean
+	static bool TrimCacheEraseBlock(uint16_t sector) {
+		// Without the cache state nothing is known clean, leave it to the
+		// per-sector path (which reports the missing cache)
+		if (!TCLayer[0]) return false;
+		for (uint16_t i = sector; i < sector+ERASE_BLOCK_SECTS; i++) {
+			uint16_t bitIdx = 1 << (i % 16);
+		#if VFATFS_CONSERVE_LEVEL >= 1
+			if ((TCLayer[0][i/16]&bitIdx) && (TCLayer[1][i/16]&bitIdx))
+		#else
+			if (TCLayer[0][i/16]&bitIdx)
+		#endif
+				return false;
+		}
+		ESPFAT_DEBUGVV("[VFATFS] E #%d (%d)\n", sector, ERASE_BLOCK_SECTS);
+		uint16_t erase_base = VFATFS_PHYS_ADDR/VFATFS_SECTOR_SIZE;
+		int ret = FlashEraseBlock((erase_base+sector)/ERASE_BLOCK_SECTS);
+		if (ret != 0) {
+			ESPFAT_DEBUG("[VFATFS] Erase of #%d (%d) failed!\n",
+				sector, ERASE_BLOCK_SECTS);
+			return false;
+		}
+		// Mark as clean
+		for (uint16_t i = sector; i < sector+ERASE_BLOCK_SECTS; i++) {
+			TCLayer[0][i/16] |= 1 << (i % 16);
+		#if VFATFS_CONSERVE_LEVEL >= 1
+			TCLayer[1][i/16] |= 1 << (i % 16);
+		#endif
+		}
+		return true;
+	}
+
+	#endif
+
 	static void TrimCacheClearPrep(uint16_t sector, uint16_t count) {
 		if (!TCLayer[0]) {
 			ESPFAT_DEBUG("[VFATFS] TrimCache not available!\n");
@@ -335,6 +571,23 @@ extern "C" uint32_t _SPIFFS_end;
 		uint16_t wordIdx = sector / 16;
 		uint16_t bitIdx = 1 << (sector % 16);
 		while (count--) {
+#if !VFATFS_BGTRIM_INTERVAL && VFATFS_BLOCK_ERASE
+			// Erase whole block at once, if none is known clean
+			if (BLOCK_ERASABLE(sector, count+1) && TrimCacheEraseBlock(sector)) {
+				sector+= ERASE_BLOCK_SECTS;
+				count-= ERASE_BLOCK_SECTS-1;
+				wordIdx = sector / 16;
+				bitIdx = 1 << (sector % 16);
+	#if VFATFS_LAZY_TRIM
+				if (!--trimlimit) {
+					ESPFAT_DEBUGV("[VFATFS] Lazy trim stopped, %d uncheck!\n",
+						count);
+					break;
+				}
+	#endif
+				continue;
+			}
+#endif
 			bool L0State = TCLayer[0][wordIdx]&bitIdx;
 #if VFATFS_CONSERVE_LEVEL >= 1
 			bool L1State = TCLayer[1][wordIdx]&bitIdx;
@@ -402,90 +655,127 @@ extern "C" uint32_t _SPIFFS_end;
 #endif
 
 /*-----------------------------------------------------------------------*/
-/* Initialize a Drive																										*/
-/*-----------------------------------------------------------------------*/
-
-DSTATUS disk_initialize (
-	BYTE pdrv					/* Physical drive nmuber (0..) */
-) {
-	if (pdrv != 0)
-		return STA_NODISK;
-
-#ifdef VFATFS_TRIMCACHE
-	TrimCacheInit();
-#endif
-	return 0;
-}
-
-/*-----------------------------------------------------------------------*/
-/* Get Disk Status																											*/
+/* Read Flash Sector(s)																												*/
 /*-----------------------------------------------------------------------*/
 
-DSTATUS disk_status (
-	BYTE pdrv					/* Physical drive nmuber (0..) */
-) {
-	if (pdrv != 0)
-		return STA_NODISK;
+// Limit sectors per read transaction, flash cache is disabled throughout
+#define READ_RUN_MAX	16
+
+// Read into possibly unaligned buffer
+static int FlashReadRaw(uint32_t addr, BYTE *buff, size_t size) {
+	if (!((uint32_t)buff & 3))
+		return spi_flash_read(addr, (uint32_t*)buff, size);
+	// Bounce through aligned stack buffer
+	uint32_t bounce[VFATFS_PAGE_SIZE/4];
+	while (size) {
+		int ret = spi_flash_read(addr, bounce, VFATFS_PAGE_SIZE);
+		if (ret != 0) return ret;
+		memcpy(buff, bounce, VFATFS_PAGE_SIZE);
+		addr+= VFATFS_PAGE_SIZE;
+		buff+= VFATFS_PAGE_SIZE;
+		size-= VFATFS_PAGE_SIZE;
+	}
 	return 0;
 }
 
-/*-----------------------------------------------------------------------*/
-/* Read Sector(s)																												*/
-/*-----------------------------------------------------------------------*/
-
-DRESULT disk_read (
-	BYTE pdrv,				/* Physical drive nmuber (0..) */
+static DRESULT FlashRead (
 	BYTE *buff,				/* Data buffer to store read data */
 	DWORD sector,			/* Sector address (LBA) */
 	UINT count				/* Number of sectors to read (1..128) */
 ) {
-	if (pdrv != 0)
-		return RES_PARERR;
-
 	ESPFAT_DEBUGV("[VFATFS] Reading @%d (%d)\n", sector, count);
 	bool prolonged = (count > 16);
 	if (prolonged) system_soft_wdt_stop();
 	else system_soft_wdt_feed();
 
-	int ret;
+	int ret = 0;
 	uint32_t addr = VFATFS_PHYS_ADDR + sector * VFATFS_SECTOR_SIZE;
-	while (count--) {
+	while (count) {
+		// Collect a run of sectors that need actual read
+		UINT run = 0;
+		bool trimmed = false;
 #ifdef VFATFS_TRIMCACHE
-		if (TrimCacheLookup(sector++, -1)) {
-			// Sector was trimmed, just fill the space
-			ESPFAT_DEBUGVV("[VFATFS] C #%d\n", sector-1);
-			memset(buff, 0xff, VFATFS_SECTOR_SIZE);
-		} else // Otherwise,
+		while (run < count && run < READ_RUN_MAX &&
+			!(trimmed = TrimCacheLookup(sector+run, -1))) run++;
 #else
-		sector++;
+		run = count < READ_RUN_MAX? count : READ_RUN_MAX;
 #endif
-		{
-			// Perform actual read if sector is not trimmed
-			ESPFAT_DEBUGVV("[VFATFS] R #%d\n", sector-1);
-			ret = spi_flash_read(addr, (uint32_t*)buff, VFATFS_SECTOR_SIZE);
+		if (run) {
+			// Perform actual read of sectors not trimmed
+			ESPFAT_DEBUGVV("[VFATFS] R #%d (%d)\n", sector, run);
+			ret = FlashReadRaw(addr, buff, run * VFATFS_SECTOR_SIZE);
 			if (ret != 0) break;
+			while (run--) {
+#if VFATFS_CONSERVE_LEVEL >= 1
+				// Probe with the data just read, instead of reading it twice
+				if (!((uint32_t)buff & 3))
+					TrimCacheProbed(sector, (const uint32_t*)buff);
+#endif
+				sector++;
+				count--;
+				addr+= VFATFS_SECTOR_SIZE;
+				buff+= VFATFS_SECTOR_SIZE;
+			}
+		}
+		if (trimmed) {
+			// Sector was trimmed, just fill the space
+			ESPFAT_DEBUGVV("[VFATFS] C #%d\n", sector);
+			memset(buff, 0xff, VFATFS_SECTOR_SIZE);
+			sector++;
+			count--;
+			addr+= VFATFS_SECTOR_SIZE;
+			buff+= VFATFS_SECTOR_SIZE;
 		}
-		addr+= VFATFS_SECTOR_SIZE;
-		buff+= VFATFS_SECTOR_SIZE;
 	}
 	if (prolonged) system_soft_wdt_restart();
 
-	return (count+1) ? RES_ERROR : RES_OK;
+	return ret ? RES_ERROR : RES_OK;
 }
 
 /*-----------------------------------------------------------------------*/
-/* Write Sector(s)																											*/
+/* Write Flash Sector(s)																											*/
 /*-----------------------------------------------------------------------*/
 
-DRESULT disk_write (
-	BYTE pdrv,			/* Physical drive nmuber (0..) */
+// Pages holding any 0 bit, which need to be programmed into erased sector
+static uint16_t NonBlankPages(const uint32_t* data) {
+	uint16_t pages = 0;
+	for (int i = 0; i < VFATFS_SECT_PAGES; i++, data+= VFATFS_PAGE_SIZE/4) {
+		int ret = VFATFS_PAGE_SIZE/4;
+		while (ret--) if (data[ret]+1) break;
+		if (ret >= 0) pages |= 1 << i;
+	}
+	return pages;
+}
+
+// Program selected pages of a sector, adjacent pages are merged
+static int ProgramPages(uint32_t addr, const BYTE* buff, uint16_t pages) {
+	int idx = 0;
+	while (pages) {
+		if (!(pages & 1)) {
+			pages >>= 1;
+			idx++;
+			continue;
+		}
+		int cnt = 0;
+		while (pages & 1) {
+			pages >>= 1;
+			cnt++;
+		}
+		int ret = spi_flash_write(addr + idx*VFATFS_PAGE_SIZE,
+			(uint32_t*)(buff + idx*VFATFS_PAGE_SIZE), cnt*VFATFS_PAGE_SIZE);
+		if (ret != 0) return ret;
+		idx+= cnt;
+	}
+	return 0;
+}
+
+static DRESULT FlashWrite (
 	const BYTE *buff, 	/* Data to be written */
 	DWORD sector,		/* Sector address (LBA) */
-	UINT count			/* Number of sectors to write (1..128) */
+	UINT count,			/* Number of sectors to write (1..128) */
+	uint16_t pages,		/* Pages that may differ from flash content */
+	bool append			/* Written by append-mode file */
 ) {
-	if (pdrv != 0)
-		return RES_PARERR;
-
 	ESPFAT_DEBUGV("[VFATFS] Writing @%d (%d)\n", sector, count);
 	bool prolonged = (count > 8);
 	if (prolonged) system_soft_wdt_stop();
@@ -495,13 +785,17 @@ DRESULT disk_write (
 	uint16_t erase_base = VFATFS_PHYS_ADDR/VFATFS_SECTOR_SIZE;
 	uint32_t addr = VFATFS_PHYS_ADDR + sector * VFATFS_SECTOR_SIZE;
 	while (count--) {
+#if defined(VFATFS_TRIMCACHE) && VFATFS_BLOCK_ERASE
+		// Whole block to be overwritten, erase at once unless any is clean
+		// Following lookups then find the sectors clean
+		if (BLOCK_ERASABLE(sector, count+1)) TrimCacheEraseBlock(sector);
+#endif
+		// All 1 bit pages need not to be programmed after erase
+		uint16_t progpages = NonBlankPages((const uint32_t*)buff);
 #ifdef VFATFS_TRIMCACHE
 	#if VFATFS_CONSERVE_LEVEL >= 2
-		// Test if write is all 1 bits (no need to write)
-		ret = VFATFS_SECTOR_SIZE/4;
-		while (ret--) if (((uint32_t*)buff)[ret]+1) break;
-		bool __needwrite__ = (ret >= 0);
-		if (!TrimCacheLookup(sector++, __needwrite__?1:0))
+		// Write of all 1 bits does not mark sector dirty
+		if (!TrimCacheLookup(sector++, progpages?1:0))
 	#else
 		if (!TrimCacheLookup(sector++, 1))
 	#endif
@@ -509,23 +803,35 @@ DRESULT disk_write (
 		sector++;
 #endif
 		{
-			// Need to erase before write
-			ESPFAT_DEBUGVV("[VFATFS] E #%d\n", sector-1);
-			ret = spi_flash_erase_sector(erase_base+sector-1);
-			if (ret != 0) break;
+#if VFATFS_CONSERVE_LEVEL >= 1
+			// Check against current content, erase only if necessary
+			uint16_t diffpages = pages;
+			int8_t delta = (VFATFS_CONSERVE_LEVEL >= 3 || append)?
+				CompareSector(sector-1, (const uint32_t*)buff, diffpages) : -1;
+			if (!delta) {
+				// Identical content, no need to erase or write
+				ESPFAT_DEBUGVV("[VFATFS] S #%d\n", sector-1);
+				progpages = 0;
+			} else if (delta > 0) {
+				// Only clears bits, program changed pages over existing content
+				ESPFAT_DEBUGVV("[VFATFS] P #%d\n", sector-1);
+				progpages = diffpages;
+			} else
+#endif
+			{
+				// Need to erase before write
+				ESPFAT_DEBUGVV("[VFATFS] E #%d\n", sector-1);
+				ret = spi_flash_erase_sector(erase_base+sector-1);
+				if (ret != 0) break;
+			}
 		}
-#ifdef VFATFS_TRIMCACHE
-	#if VFATFS_CONSERVE_LEVEL >= 2
-		if (!__needwrite__) {
+		if (!progpages) {
 			// No need to actually write anything
 			ESPFAT_DEBUGVV("[VFATFS] C #%d\n", sector-1);
-		} else
-	#endif
-#endif
-		{
+		} else {
 			// Perform actual write
-			ESPFAT_DEBUGVV("[VFATFS] W #%d\n", sector-1);
-			ret = spi_flash_write(addr, (uint32_t*)buff, VFATFS_SECTOR_SIZE);
+			ESPFAT_DEBUGVV("[VFATFS] W #%d [%04x]\n", sector-1, progpages);
+			ret = ProgramPages(addr, buff, progpages);
 			if (ret != 0) break;
 		}
 		addr+= VFATFS_SECTOR_SIZE;
@@ -536,6 +842,243 @@ DRESULT disk_write (
 	return (count+1) ? RES_ERROR : RES_OK;
 }
 
+#if VFATFS_SECTCACHE
+
+	#define SECTCACHE_EMPTY ((DWORD)-1)
+
+	typedef struct {
+		DWORD sector;		// SECTCACHE_EMPTY if not in use
+		uint32_t stamp;		// Last access, for LRU replacement
+		uint16_t pages;		// Dirty pages pending write-back
+		bool append;		// Written by append-mode file
+		BYTE* data;
+	} SectCacheEntry;
+
+	static SectCacheEntry SCEntry[VFATFS_SECTCACHE] = { 0 };
+	static uint32_t SCClock = 0;
+	// Set while FatFs transfers FAT sectors it buffers by itself
+	static bool SCBypass = false;
+	static VFATCacheStats SCStats = { 0 };
+
+	static void SectCacheInit() {
+		if (!SCEntry[0].data) {
+			ESPFAT_DEBUGV("[VFATFS] SectCache[#%d]\n",
+				VFATFS_SECTCACHE*VFATFS_SECTOR_SIZE);
+			BYTE* SECTCACHE = (BYTE*) malloc(VFATFS_SECTCACHE*VFATFS_SECTOR_SIZE);
+			if (SECTCACHE) {
+				for (int i = 0; i < VFATFS_SECTCACHE; i++) {
+					SCEntry[i].sector = SECTCACHE_EMPTY;
+					SCEntry[i].pages = 0;
+					SCEntry[i].append = false;
+					SCEntry[i].data = SECTCACHE + i*VFATFS_SECTOR_SIZE;
+				}
+			} else {
+				ESPFAT_DEBUG("[VFATFS] Failed to allocate sector cache!\n");
+			}
+		}
+	}
+
+	static SectCacheEntry* SectCacheFind(DWORD sector) {
+		for (int i = 0; i < VFATFS_SECTCACHE; i++)
+			if (SCEntry[i].sector == sector) return &SCEntry[i];
+		return nullptr;
+	}
+
+	static bool SectCacheFlush(SectCacheEntry* entry) {
+		if (entry->pages) {
+			ESPFAT_DEBUGVV("[VFATFS] SectCache[%d] write-back [%04x]\n",
+				entry->sector, entry->pages);
+			if (FlashWrite(entry->data, entry->sector, 1, entry->pages,
+				entry->append) != RES_OK)
+				return false;
+			entry->pages = 0;
+			SCStats.writebacks++;
+		}
+		entry->append = false;
+		return true;
+	}
+
+	// Release the least recently used entry for reuse
+	static SectCacheEntry* SectCacheEvict() {
+		SectCacheEntry* victim = &SCEntry[0];
+		for (int i = 0; i < VFATFS_SECTCACHE; i++) {
+			if (SCEntry[i].sector == SECTCACHE_EMPTY) {
+				victim = &SCEntry[i];
+				break;
+			}
+			if ((int32_t)(SCEntry[i].stamp - victim->stamp) < 0)
+				victim = &SCEntry[i];
+		}
+		if (!SectCacheFlush(victim)) return nullptr;
+		victim->sector = SECTCACHE_EMPTY;
+		return victim;
+	}
+
+	static bool SectCacheSync() {
+		bool ret = true;
+		for (int i = 0; i < VFATFS_SECTCACHE; i++)
+			if (SCEntry[i].sector != SECTCACHE_EMPTY)
+				ret &= SectCacheFlush(&SCEntry[i]);
+		return ret;
+	}
+
+	static uint16_t DiffPages(const BYTE* a, const BYTE* b) {
+		uint16_t pages = 0;
+		for (int i = 0; i < VFATFS_SECT_PAGES; i++) {
+			if (memcmp(a, b, VFATFS_PAGE_SIZE)) pages |= 1 << i;
+			a+= VFATFS_PAGE_SIZE;
+			b+= VFATFS_PAGE_SIZE;
+		}
+		return pages;
+	}
+
+	// Drop cached content (including pending write-back) in range
+	static void SectCacheDrop(DWORD sector, UINT count) {
+		for (int i = 0; i < VFATFS_SECTCACHE; i++) {
+			if (SCEntry[i].sector - sector < count) {
+				SCEntry[i].sector = SECTCACHE_EMPTY;
+				SCEntry[i].pages = 0;
+				SCEntry[i].append = false;
+			}
+		}
+	}
+
+#endif
+
+/*-----------------------------------------------------------------------*/
+/* Initialize a Drive																										*/
+/*-----------------------------------------------------------------------*/
+
+DSTATUS disk_initialize (
+	BYTE pdrv					/* Physical drive nmuber (0..) */
+) {
+	if (pdrv != 0)
+		return STA_NODISK;
+
+#ifdef VFATFS_TRIMCACHE
+	TrimCacheInit();
+#endif
+#if VFATFS_SECTCACHE
+	SectCacheInit();
+#endif
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Get Disk Status																											*/
+/*-----------------------------------------------------------------------*/
+
+DSTATUS disk_status (
+	BYTE pdrv					/* Physical drive nmuber (0..) */
+) {
+	if (pdrv != 0)
+		return STA_NODISK;
+	return 0;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Read Sector(s)																												*/
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_read (
+	BYTE pdrv,				/* Physical drive nmuber (0..) */
+	BYTE *buff,				/* Data buffer to store read data */
+	DWORD sector,			/* Sector address (LBA) */
+	UINT count				/* Number of sectors to read (1..128) */
+) {
+	if (pdrv != 0)
+		return RES_PARERR;
+
+#if VFATFS_SECTCACHE
+	if (SCEntry[0].data) {
+		SectCacheEntry* entry;
+		if (count == 1 && !SCBypass) {
+			// Single sector reads (FAT / directory window) are cached
+			if ((entry = SectCacheFind(sector))) {
+				SCStats.hits++;
+			} else {
+				SCStats.misses++;
+				if (!(entry = SectCacheEvict()))
+					return RES_ERROR;
+				if (FlashRead(entry->data, sector, 1) != RES_OK)
+					return RES_ERROR;
+				entry->sector = sector;
+			}
+			entry->stamp = ++SCClock;
+			memcpy(buff, entry->data, VFATFS_SECTOR_SIZE);
+			return RES_OK;
+		}
+		// Bulk reads (file data, buffered FAT) pass through, so they do not
+		//  flush the cache
+		// Cached sectors are overlaid, since they may hold pending write-back
+		if (FlashRead(buff, sector, count) != RES_OK)
+			return RES_ERROR;
+		SCStats.misses+= count;
+		for (int i = 0; i < VFATFS_SECTCACHE; i++) {
+			entry = &SCEntry[i];
+			if (entry->sector - sector < count) {
+				SCStats.misses--;
+				SCStats.hits++;
+				entry->stamp = ++SCClock;
+				memcpy(buff + (entry->sector - sector) * VFATFS_SECTOR_SIZE,
+					entry->data, VFATFS_SECTOR_SIZE);
+			}
+		}
+		return RES_OK;
+	}
+#endif
+	return FlashRead(buff, sector, count);
+}
+
+/*-----------------------------------------------------------------------*/
+/* Write Sector(s)																											*/
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_write (
+	BYTE pdrv,			/* Physical drive nmuber (0..) */
+	const BYTE *buff, 	/* Data to be written */
+	DWORD sector,		/* Sector address (LBA) */
+	UINT count			/* Number of sectors to write (1..128) */
+) {
+	if (pdrv != 0)
+		return RES_PARERR;
+
+#if VFATFS_SECTCACHE
+	if (SCEntry[0].data) {
+		if (count == 1 && !SCBypass) {
+			// Single sector writes are deferred until sync or eviction
+			// Changed pages are tracked, so write-back can skip the rest
+			SectCacheEntry* entry = SectCacheFind(sector);
+			if (entry) {
+				SCStats.hits++;
+				entry->pages |= DiffPages(entry->data, buff);
+			} else {
+				SCStats.misses++;
+				if (!(entry = SectCacheEvict()))
+					return RES_ERROR;
+				entry->sector = sector;
+				entry->pages = SECT_PAGES_ALL;
+			}
+	#if VFATFS_CONSERVE_LEVEL >= 1
+			entry->append |= AppendWrite;
+	#endif
+			ESPFAT_DEBUGVV("[VFATFS] SectCache[%d] deferred [%04x]\n",
+				sector, entry->pages);
+			entry->stamp = ++SCClock;
+			memcpy(entry->data, buff, VFATFS_SECTOR_SIZE);
+			return RES_OK;
+		}
+		// Bulk writes go straight to flash, superseding cached content
+		SectCacheDrop(sector, count);
+	}
+#endif
+#if VFATFS_CONSERVE_LEVEL >= 1
+	return FlashWrite(buff, sector, count, SECT_PAGES_ALL, AppendWrite);
+#else
+	return FlashWrite(buff, sector, count, SECT_PAGES_ALL, false);
+#endif
+}
+
 /*-----------------------------------------------------------------------*/
 /* Miscellaneous Functions																							*/
 /*-----------------------------------------------------------------------*/
@@ -550,11 +1093,20 @@ DRESULT disk_ioctl (
 
 	switch (cmd) {
 		case CTRL_SYNC:
-			// NOP
+#if VFATFS_SECTCACHE
+			if (SCEntry[0].data && !SectCacheSync())
+				return RES_ERROR;
+#endif
+			return RES_OK;
+
+		case CTRL_CACHE_BYPASS:
+#if VFATFS_SECTCACHE
+			SCBypass = *((BYTE*)buff) != 0;
+#endif
 			return RES_OK;
 
 		case GET_SECTOR_COUNT:
-			*((DWORD*)buff) = VFATFS_PHYS_SIZE / VFATFS_SECTOR_SIZE;
+			*((DWORD*)buff) = VFATFS_DISK_SECTORS;
 			return RES_OK;
 
 		case GET_SECTOR_SIZE:
@@ -563,17 +1115,26 @@ DRESULT disk_ioctl (
 
 		case GET_BLOCK_SIZE:
 			// erase block size in units of sector size
+#if VFATFS_LAYOUT_ALIGN
+			// Report 64KB block so partitions, FAT and data are laid out on it
+			*((DWORD*)buff) = 0x10000/VFATFS_SECTOR_SIZE;
+#else
 			*((DWORD*)buff) = VFATFS_SECT_PER_PHYS;
+#endif
 			return RES_OK;
 
-		case CTRL_TRIM:
-#ifdef VFATFS_TRIMCACHE
+		case CTRL_TRIM: {
 			DWORD *range = (DWORD*)buff;
 			ESPFAT_DEBUGV("[VFATFS] Trimming @[%d, %d]\n", range[0], range[1]);
 			uint32_t count = range[1] - range[0] + 1;
+#if VFATFS_SECTCACHE
+			// Trimmed content is discarded, including pending write-back
+			SectCacheDrop(range[0], count);
+#endif
+#ifdef VFATFS_TRIMCACHE
 			TrimCacheClearPrep(range[0], count);
 #endif
-			return RES_OK;
+		}	return RES_OK;
 	}
 
 	ESPFAT_DEBUG("[VFATFS] Unhandled Disk IOCTL - %d\n", cmd);
@@ -659,6 +1220,15 @@ bool VFATPartitions::config(uint8_t A, uint8_t B, uint8_t C, uint8_t D) {
 	return true;
 }
 
+#if VFATFS_SECTCACHE
+
+void VFATPartitions::sectCacheStats(VFATCacheStats& stats, bool reset) {
+	stats = SCStats;
+	if (reset) SCStats = { 0 };
+}
+
+#endif
+
 // FS
 
 #define CSTR_NODRV(s) s.c_str()+2
@@ -690,8 +1260,16 @@ bool VFATFSImpl::unmount() {
 		ESPFAT_DEBUGV("[VFATFSImpl::unmount] Error %d\n", res);
 		return false;
 	}
+	// Write back whatever is still deferred in the disk layer
+	if (disk_ioctl(_fatfs.pdrv, CTRL_SYNC, NULL) != RES_OK) {
+		ESPFAT_DEBUGV("[VFATFSImpl::unmount] Sync failed\n");
+	}
 	_mounted = false;
 	uint8_t mountCnt = --VFATPartitions::_opencnt;
+#if defined(VFATFS_TRIMCACHE) && VFATFS_TCSTORE
+	// Checkpoint trim cache when the disk is no longer in use
+	if (!mountCnt) TrimCacheSave();
+#endif
 	ESPFAT_DEBUGVV("[VFATFSImpl::unmount] Unmounted %s (#%d)\n",
 		DrvRoot.c_str(), mountCnt);
 	return true;
@@ -723,7 +1301,139 @@ void VFATFSImpl::end() {
 	unmount();
 }
 
+// Format profiles
+
+#define MAX_FAT12	0xFF5
+
+struct FormatProfile {
+	uint32_t clusterSize;	// Preferred cluster size, 0 follows FatFs heuristic
+	uint16_t rootEntries;
+};
+
+static const FormatProfile FormatProfiles[] = {
+	{ 0, 512 },			// VFAT_FORMAT_DEFAULT
+	{ 4096, 1024 },		// VFAT_FORMAT_SMALLFILES
+	{ 32768, 128 },		// VFAT_FORMAT_LARGEFILES
+	{ 16384, 256 },		// VFAT_FORMAT_LOGSTORE
+};
+
+static bool PartitionGeometry(uint8_t partno, DWORD& base, DWORD& size) {
+	if (disk_initialize(0) & STA_NOINIT) return false;
+	BYTE* mbr = (BYTE*)malloc(VFATFS_SECTOR_SIZE);
+	if (!mbr) return false;
+
+	bool valid = (disk_read(0, mbr, 0, 1) == RES_OK) &&
+		(mbr[510] == 0x55) && (mbr[511] == 0xAA);
+	if (valid) {
+		BYTE* pte = mbr + 446 + (VolToPart[partno].pt - 1) * 16;
+		memcpy(&base, pte + 8, sizeof(DWORD));
+		memcpy(&size, pte + 12, sizeof(DWORD));
+		valid = pte[4] != 0;
+	}
+	free(mbr);
+	return valid;
+}
+
+// Mirrors the FAT/FAT32 volume layout computation of f_mkfs
+static bool FormatEstimate(DWORD b_vol, DWORD sz_vol, DWORD au, UINT n_root,
+	VFATFormatInfo& info) {
+	const DWORD ss = VFATFS_SECTOR_SIZE;
+#if VFATFS_LAYOUT_ALIGN
+	const DWORD sz_blk = 0x10000/VFATFS_SECTOR_SIZE;
+#else
+	const DWORD sz_blk = VFATFS_SECT_PER_PHYS;
+#endif
+	DWORD n_clst = sz_vol / au;
+	DWORD sz_rsv, sz_fat, sz_dir;
+
+	// f_mkfs picks FAT sub-type from the raw cluster count, a flash partition
+	//  (fewer than 4096 sectors) never has enough for FAT16
+	if (n_clst > MAX_FAT12) return false;
+	info.fatType = FS_FAT12;
+	sz_fat = ((n_clst * 3 + 1) / 2 + 3 + ss - 1) / ss;
+#if FF_ALLOC_SUMMARY
+	// VBR and allocation summary
+	sz_rsv = ((b_vol + 2 + sz_blk - 1) & ~(sz_blk - 1)) - b_vol;
+#else
+	sz_rsv = sz_blk - b_vol % sz_blk;
+#endif
+	sz_dir = n_root * 32 / ss;
+	DWORD b_data = b_vol + sz_rsv + sz_fat + sz_dir;
+	sz_fat += ((b_data + sz_blk - 1) & ~(sz_blk - 1)) - b_data;
+
+	DWORD sz_meta = sz_rsv + sz_fat + sz_dir;
+	if (sz_vol < sz_meta + au * 16) return false;
+	n_clst = (sz_vol - sz_meta) / au;
+
+	info.clusterSize = au * ss;
+	info.rootEntries = n_root;
+	info.clusters = n_clst;
+	info.overhead = sz_meta * ss;
+	return true;
+}
+
+static bool FormatPlan(VFATFormatProfile profile, DWORD b_vol, DWORD sz_vol,
+	VFATFormatInfo& info) {
+	static const WORD cst[] = {1, 4, 16, 64, 256, 512, 0};	// Same as f_mkfs
+	const FormatProfile& prof = FormatProfiles[profile];
+	UINT n_root = prof.rootEntries;
+	DWORD au_pref, au;
+
+	if (prof.clusterSize > VFATFS_SECTOR_SIZE) {
+		au_pref = prof.clusterSize / VFATFS_SECTOR_SIZE;
+	} else if (prof.clusterSize) {
+		au_pref = 1;
+	} else {
+		DWORD n = sz_vol / 0x1000;
+		au_pref = 1;
+		for (int i = 0; cst[i] && cst[i] <= n; i++) au_pref <<= 1;
+	}
+
+	// Every flash partition is FAT12, profiles differ in cluster size and
+	//  root directory only
+	// Shrink clusters if the partition is too small for the preferred size
+	for (au = au_pref; au; au >>= 1)
+		if (FormatEstimate(b_vol, sz_vol, au, n_root, info)) return true;
+	return false;
+}
+
+bool VFATFSImpl::formatPlan(VFATFormatProfile profile, VFATFormatInfo& info) const {
+	if (profile > VFAT_FORMAT_LOGSTORE) {
+		ESPFAT_DEBUGV("[VFATFSImpl::formatPlan] Invalid profile %d\n", profile);
+		return false;
+	}
+
+	DWORD b_vol, sz_vol;
+	if (!PartitionGeometry(_partno, b_vol, sz_vol)) {
+		ESPFAT_DEBUGV("[VFATFSImpl::formatPlan] Partition #%d not found\n", _partno);
+		return false;
+	}
+	if (!FormatPlan(profile, b_vol, sz_vol, info)) {
+		ESPFAT_DEBUGV("[VFATFSImpl::formatPlan] No valid layout for %d sectors\n",
+			sz_vol);
+		return false;
+	}
+	ESPFAT_DEBUGV("[VFATFSImpl::formatPlan] FAT%d, %d x %d bytes clusters, "
+		"%d root entries, %d bytes overhead\n",
+		info.fatType == FS_FAT32? 32 : info.fatType == FS_FAT16? 16 : 12,
+		info.clusters, info.clusterSize, info.rootEntries, info.overhead);
+	return true;
+}
+
 bool VFATFSImpl::format() {
+	return format(VFAT_FORMAT_DEFAULT);
+}
+
+bool VFATFSImpl::format(VFATFormatProfile profile, VFATFormatInfo* info) {
+	DWORD au = 0;	// Default profile leaves layout to FatFs
+	if (profile != VFAT_FORMAT_DEFAULT) {
+		VFATFormatInfo plan;
+		if (!formatPlan(profile, plan)) {
+			return false;
+		}
+		au = plan.clusterSize;
+	}
+
 	bool wasMounted = _mounted;
 
 	if (wasMounted) {
@@ -736,15 +1446,30 @@ bool VFATFSImpl::format() {
 	DrvRoot.concat(":/",2);
 	ESPFAT_DEBUGVV("[VFATFSImpl::format] Format '%s' in progress...\n",
 		DrvRoot.c_str());
-	FRESULT res = f_mkfs(DrvRoot.c_str(), FM_FAT, 0, _fatfs.win, FF_MAX_SS);
+	FRESULT res = f_mkfs(DrvRoot.c_str(), FM_FAT, au,
+		FormatProfiles[profile].rootEntries, _fatfs.win, FF_MAX_SS);
+	if (res == FR_MKFS_ABORTED && au) {
+		// f_mkfs does not retry an explicit cluster size, leave it to FatFs
+		ESPFAT_DEBUGV("[VFATFSImpl::format] Cluster size %d rejected\n", au);
+		res = f_mkfs(DrvRoot.c_str(), FM_FAT, 0,
+			FormatProfiles[profile].rootEntries, _fatfs.win, FF_MAX_SS);
+	}
 	if (res != FR_OK) {
 		ESPFAT_DEBUGV("[VFATFSImpl::format] Error %d\n", res);
 		return false;
 	}
 	ESPFAT_DEBUGVV("[VFATFSImpl::format] Done %s\n", DrvRoot.c_str());
 
-	if (wasMounted) {
-		mount();
+	if (wasMounted || info) {
+		// Report the layout f_mkfs actually created
+		if (mount() && info) {
+			info->fatType = _fatfs.fs_type;
+			info->clusterSize = _fatfs.csize * VFATFS_SECTOR_SIZE;
+			info->rootEntries = (_fatfs.fs_type == FS_FAT32)? 0 : _fatfs.n_rootdir;
+			info->clusters = _fatfs.n_fatent - 2;
+			info->overhead = (_fatfs.database - _fatfs.volbase) * VFATFS_SECTOR_SIZE;
+		}
+		if (!wasMounted && _mounted) unmount();
 	}
 	return true;
 }
@@ -772,6 +1497,99 @@ bool VFATFSImpl::info(FSInfo& info) const {
 	return true;
 }
 
+#if FF_FAT_CACHE
+
+bool VFATFSImpl::fatCacheStats(VFATCacheStats& stats, bool reset) {
+	if (!_mounted || !_fatfs.fcbuf) {
+		ESPFAT_DEBUGV("[VFATFSImpl::fatCacheStats] FAT cache not in use\n");
+		return false;
+	}
+	stats.hits = _fatfs.fc_hit;
+	stats.misses = _fatfs.fc_miss;
+	stats.writebacks = _fatfs.fc_wback;
+	if (reset) _fatfs.fc_hit = _fatfs.fc_miss = _fatfs.fc_wback = 0;
+	return true;
+}
+
+#endif
+
+#if FF_DIR_INDEX
+
+size_t VFATFSImpl::dirIndexHeap() const {
+	return _mounted? _fatfs.dix_heap : 0;
+}
+
+#endif
+
+#if FF_PATH_CACHE
+
+bool VFATFSImpl::pathCacheStats(VFATCacheStats& stats, bool reset) {
+	if (!_mounted) {
+		ESPFAT_DEBUGV("[VFATFSImpl::pathCacheStats] Not mounted\n");
+		return false;
+	}
+	stats.hits = _fatfs.pc_hit;
+	stats.misses = _fatfs.pc_miss;
+	stats.writebacks = 0;
+	if (reset) _fatfs.pc_hit = _fatfs.pc_miss = 0;
+	return true;
+}
+
+#endif
+
+#if FF_NEG_CACHE
+
+bool VFATFSImpl::negCacheStats(VFATCacheStats& stats, bool reset) {
+	if (!_mounted) {
+		ESPFAT_DEBUGV("[VFATFSImpl::negCacheStats] Not mounted\n");
+		return false;
+	}
+	stats.hits = _fatfs.nc_hit;
+	stats.misses = _fatfs.nc_miss;
+	stats.writebacks = 0;
+	if (reset) _fatfs.nc_hit = _fatfs.nc_miss = 0;
+	return true;
+}
+
+#endif
+
+static void LayoutRegion(VFATLayoutRegion& region, DWORD sector, DWORD count) {
+	region.start = VFATFS_PHYS_ADDR + sector * VFATFS_SECTOR_SIZE;
+	region.size = count * VFATFS_SECTOR_SIZE;
+	region.align = 0x10000;
+	while (region.start & (region.align - 1)) region.align >>= 1;
+}
+
+bool VFATFSImpl::layout(VFATLayoutInfo& info) const {
+	if (!_mounted) {
+		ESPFAT_DEBUGV("[VFATFSImpl::layout] Not mounted\n");
+		return false;
+	}
+
+	DWORD fatsz = _fatfs.fsize * _fatfs.n_fats;
+	DWORD datasz = (_fatfs.n_fatent - 2) * _fatfs.csize;
+	DWORD dirsz = (_fatfs.fs_type == FS_FAT32)? 0 :
+		_fatfs.n_rootdir * 32 / VFATFS_SECTOR_SIZE;	// 32 bytes per entry
+	DWORD volsz = _fatfs.database + datasz - _fatfs.volbase;
+
+	LayoutRegion(info.volume, _fatfs.volbase, volsz);
+	LayoutRegion(info.fat, _fatfs.fatbase, fatsz);
+	LayoutRegion(info.rootdir, (_fatfs.fs_type == FS_FAT32)?
+		_fatfs.database : _fatfs.dirbase, dirsz);
+	LayoutRegion(info.data, _fatfs.database, datasz);
+	info.clusterSize = _fatfs.csize * VFATFS_SECTOR_SIZE;
+
+	ESPFAT_DEBUGV("[VFATFSImpl::layout] Volume @0x%08x +%d (align %d)\n",
+		info.volume.start, info.volume.size, info.volume.align);
+	ESPFAT_DEBUGV("[VFATFSImpl::layout] FAT    @0x%08x +%d (align %d)\n",
+		info.fat.start, info.fat.size, info.fat.align);
+	ESPFAT_DEBUGV("[VFATFSImpl::layout] Root   @0x%08x +%d (align %d)\n",
+		info.rootdir.start, info.rootdir.size, info.rootdir.align);
+	ESPFAT_DEBUGV("[VFATFSImpl::layout] Data   @0x%08x +%d (align %d)\n",
+		info.data.start, info.data.size, info.data.align);
+	return true;
+}
+
 bool VFATFSImpl::exists(const char* path) const {
 	String normPath;
 	if (!normalizePath(path, _partno, normPath)) {
@@ -790,37 +1608,99 @@ bool VFATFSImpl::exists(const char* path) const {
 }
 
 bool VFATFSImpl::isDir(const char* path) const {
-	FILINFO stats;
-	FRESULT res = f_stat(path, &stats);
-	if (res != FR_OK) {
-		ESPFAT_DEBUGV("[VFATFSImpl::isDir] Error %d\n", res);
+	VFATFileStat st;
+	return stat(path, st) && st.isDir;
+}
+
+size_t VFATFSImpl::size(const char* path) const {
+	VFATFileStat st;
+	return stat(path, st)? st.size : 0;
+}
+
+time_t VFATFSImpl::mtime(const char* path) const {
+	VFATFileStat st;
+	return stat(path, st)? st.mtime : 0;
+}
+
+bool VFATFSImpl::stat(const char* path, VFATFileStat& st) const {
+	String normPath;
+	if (!normalizePath(path, _partno, normPath)) {
+		ESPFAT_DEBUGV("[VFATFSImpl::stat] Invalid path\n");
+		st = {0};
 		return false;
 	}
-	return (stats.fattrib & AM_DIR);
+
+	ESPFAT_DEBUGVV("[VFATFSImpl::stat] Normalized path '%s'\n",
+		normPath.c_str());
+	if (normPath.length() > 3)
+		return statAt(normPath.c_str(), st);
+
+	// The root directory has no entry of its own
+	st = {0};
+	st.exists = st.isDir = true;
+	st.attrib = AM_DIR;
+	return true;
 }
 
-size_t VFATFSImpl::size(const char* path) const {
+bool VFATFSImpl::statAt(const char* fpath, VFATFileStat& st) const {
 	FILINFO stats;
-	FRESULT res = f_stat(path, &stats);
+	FRESULT res = f_stat(fpath, &stats);
+	st = {0};
 	if (res != FR_OK) {
-		ESPFAT_DEBUGV("[VFATFSImpl::size] Error %d\n", res);
-		return 0;
+		if (res == FR_NO_FILE || res == FR_NO_PATH) {
+			ESPFAT_DEBUGVV("[VFATFSImpl::stat] Not found '%s'\n", fpath);
+		} else {
+			ESPFAT_DEBUGV("[VFATFSImpl::stat] Error %d\n", res);
+		}
+		return false;
 	}
 
-	return stats.fsize;
+	st.exists = true;
+	st.isDir = stats.fattrib & AM_DIR;
+	st.attrib = stats.fattrib;
+	st.size = stats.fsize;
+	st.mtime = fattime2unixts(stats.ftime, stats.fdate);
+	return true;
 }
 
-time_t VFATFSImpl::mtime(const char* path) const {
-	FILINFO stats;
-	FRESULT res = f_stat(path, &stats);
-	if (res != FR_OK) {
-		ESPFAT_DEBUGV("[VFATFSImpl::mtime] Error %d\n", res);
-		return 0;
+#if FF_USE_FASTSEEK && VFATFS_CLMT_POOL
+
+static DWORD CLMTPool[VFATFS_CLMT_POOL][VFATFS_CLMT_SIZE];
+static bool CLMTUsed[VFATFS_CLMT_POOL];
+
+static void CLMTAttach(FIL& fd) {
+	if (f_size(&fd) < VFATFS_CLMT_MINSIZE) return;
+	for (int i = 0; i < VFATFS_CLMT_POOL; i++) {
+		if (CLMTUsed[i]) continue;
+		CLMTPool[i][0] = VFATFS_CLMT_SIZE;
+		fd.cltbl = CLMTPool[i];
+		FRESULT res = f_lseek(&fd, CREATE_LINKMAP);
+		if (res != FR_OK) {
+			// Too fragmented for the table, fall back to FAT chain walking
+			ESPFAT_DEBUGV("[VFATFS] Link map not created - Error %d\n", res);
+			fd.cltbl = NULL;
+			return;
+		}
+		ESPFAT_DEBUGVV("[VFATFS] Link map #%d, %d fragments\n", i, (CLMTPool[i][0]-1)/2);
+		CLMTUsed[i] = true;
+		return;
 	}
+	ESPFAT_DEBUGV("[VFATFS] Link map pool exhausted\n");
+}
 
-	return fattime2unixts(stats.ftime, stats.fdate);
+static void CLMTRelease(FIL& fd) {
+	if (!fd.cltbl) return;
+	CLMTUsed[(fd.cltbl - CLMTPool[0]) / VFATFS_CLMT_SIZE] = false;
+	fd.cltbl = NULL;
 }
 
+#else
+
+#define CLMTAttach(fd)
+#define CLMTRelease(fd)
+
+#endif
+
 FileImplPtr VFATFSImpl::openFile(const char* path, OpenMode openMode,
 	AccessMode accessMode) {
 	String normPath;
@@ -829,6 +1709,11 @@ FileImplPtr VFATFSImpl::openFile(const char* path, OpenMode openMode,
 		return FileImplPtr();
 	}
 
+	return openFileAt(normPath.c_str(), std::move(normPath), openMode, accessMode);
+}
+
+FileImplPtr VFATFSImpl::openFileAt(const char* fpath, String && normPath,
+	OpenMode openMode, AccessMode accessMode) {
 	BYTE open_mode = 0;
 	open_mode|= (AM_READ & accessMode)? FA_READ : 0;
 	open_mode|= (AM_WRITE & accessMode)? FA_WRITE : 0;
@@ -842,12 +1727,16 @@ FileImplPtr VFATFSImpl::openFile(const char* path, OpenMode openMode,
 	}
 
 	FIL fd{0}; // Note: enable FS_TINY, or have >5K free stack space!
-	FRESULT res = f_open(&fd, normPath.c_str(), open_mode);
+	FRESULT res = f_open(&fd, fpath, open_mode);
 	if (res != FR_OK) {
 		ESPFAT_DEBUGV("[VFATFSImpl::openFile] Error %d\n", res);
 		return FileImplPtr();
 	}
-	return std::make_shared<VFATFSFileImpl>(*this, fd, std::move(normPath));
+	// Random access reads on large files follow a cluster link map
+	if (!(open_mode & FA_WRITE)) CLMTAttach(fd);
+	// Appending (without truncate) mostly programs into erased tail space
+	bool append = (OM_APPEND & openMode) && !(OM_TRUNCATE & openMode);
+	return std::make_shared<VFATFSFileImpl>(*this, fd, std::move(normPath), append);
 }
 
 DirImplPtr VFATFSImpl::openDir(const char* path, bool create) {
@@ -857,13 +1746,17 @@ DirImplPtr VFATFSImpl::openDir(const char* path, bool create) {
 		return DirImplPtr();
 	}
 
+	return openDirAt(normPath.c_str(), std::move(normPath), create);
+}
+
+DirImplPtr VFATFSImpl::openDirAt(const char* fpath, String && normPath, bool create) {
 	DIR fd{0};
-	FRESULT res = f_opendir(&fd, normPath.c_str());
+	FRESULT res = f_opendir(&fd, fpath);
 	if (res != FR_OK) {
 		if ((res == FR_NO_PATH) && create) {
-				res = f_mkdir(normPath.c_str());
+				res = f_mkdir(fpath);
 				if (res == FR_OK)
-					res = f_opendir(&fd, normPath.c_str());
+					res = f_opendir(&fd, fpath);
 		}
 	}
 	if (res != FR_OK) {
@@ -880,9 +1773,13 @@ bool VFATFSImpl::remove(const char* path) {
 		return false;
 	}
 
-	FRESULT res = f_unlink(normPath.c_str());
+	return removeAt(normPath.c_str());
+}
+
+bool VFATFSImpl::removeAt(const char* fpath) {
+	FRESULT res = f_unlink(fpath);
 	if (res != FR_OK) {
-		ESPFAT_DEBUGV("[VFATFSImpl::remove] Unable to remove path=`%s`\n", normPath.c_str());
+		ESPFAT_DEBUGV("[VFATFSImpl::remove] Unable to remove path=`%s`\n", fpath);
 		return false;
 	}
 	return true;
@@ -902,18 +1799,22 @@ bool VFATFSImpl::rename(const char* pathFrom, const char* pathTo) {
 	if (normPathFrom == normPathTo)
 		return true;
 
-	FRESULT res = f_rename(normPathFrom.c_str(), normPathTo.c_str());
+	return renameAt(normPathFrom.c_str(), normPathTo.c_str());
+}
+
+bool VFATFSImpl::renameAt(const char* fpathFrom, const char* fpathTo) {
+	FRESULT res = f_rename(fpathFrom, fpathTo);
 	if (res == FR_EXIST) {
-		res = f_unlink(normPathTo.c_str());
+		res = f_unlink(fpathTo);
 		if (res != FR_OK) {
-			ESPFAT_DEBUGV("[VFATFSImpl::rename] Unable to remove existing path=`%s`\n", normPathTo.c_str());
+			ESPFAT_DEBUGV("[VFATFSImpl::rename] Unable to remove existing path=`%s`\n", fpathTo);
 			return false;
 		}
 		// try to rename again
-		res = f_rename(normPathFrom.c_str(), normPathTo.c_str());
+		res = f_rename(fpathFrom, fpathTo);
 	}
 	if (res != FR_OK) {
-		ESPFAT_DEBUGV("[VFATFSImpl::rename] Unable to rename path=`%s`\n", normPathFrom.c_str());
+		ESPFAT_DEBUGV("[VFATFSImpl::rename] Unable to rename path=`%s`\n", fpathFrom);
 		return false;
 	}
 	return true;
@@ -921,11 +1822,20 @@ bool VFATFSImpl::rename(const char* pathFrom, const char* pathTo) {
 
 // File
 
+void VFATFSFileImpl::AppendHint(bool enable) {
+#if VFATFS_CONSERVE_LEVEL >= 1
+	AppendWrite = enable && _append;
+#endif
+}
+
 size_t VFATFSFileImpl::write(const uint8_t *buf, size_t size) {
 	MUSTNOTCLOSE();
 
 	UINT sz_out;
+	CLMTRelease(_fd);	// Link map goes stale once the file changes
+	AppendHint(true);
 	FRESULT res = f_write(&_fd, buf, size, &sz_out);
+	AppendHint(false);
 	if (res != FR_OK) {
 		ESPFAT_DEBUGV("[VFATFSFileImpl::write] Error %d\n", res);
 		return -1;
@@ -948,7 +1858,9 @@ size_t VFATFSFileImpl::read(uint8_t* buf, size_t size) {
 void VFATFSFileImpl::flush() {
 	MUSTNOTCLOSE();
 
+	AppendHint(true);
 	FRESULT res = f_sync(&_fd);
+	AppendHint(false);
 	if (res != FR_OK) {
 		ESPFAT_DEBUGV("[VFATFSFileImpl::flush] Error %d\n", res);
 	}
@@ -986,6 +1898,7 @@ bool VFATFSFileImpl::seek(uint32_t pos, SeekMode mode) {
 bool VFATFSFileImpl::truncate() {
 	MUSTNOTCLOSE();
 
+	CLMTRelease(_fd);
 	FRESULT res = f_truncate(&_fd);
 	if (res != FR_OK) {
 		ESPFAT_DEBUGV("[VFATFSFileImpl::truncate] Error %d\n", res);
@@ -994,6 +1907,21 @@ bool VFATFSFileImpl::truncate() {
 	return true;
 }
 
+bool VFATFSFileImpl::reserve(size_t size) {
+	MUSTNOTCLOSE();
+
+#if FF_EXTENT_ALLOC
+	FRESULT res = f_expand(&_fd, size, 2);
+#else
+	FRESULT res = f_expand(&_fd, size, 1);
+#endif
+	if (res != FR_OK) {
+		ESPFAT_DEBUGV("[VFATFSFileImpl::reserve] Error %d\n", res);
+		return false;
+	}
+	return true;
+}
+
 time_t VFATFSFileImpl::mtime() const {
 	return _fs.mtime(CSTR_NODRV(_pathname));
 }
@@ -1020,7 +1948,10 @@ bool VFATFSFileImpl::rename(const char *nameTo) {
 
 void VFATFSFileImpl::close() {
 	if (_fd.obj.fs) {
+		CLMTRelease(_fd);
+		AppendHint(true);
 		FRESULT res = f_close(&_fd);
+		AppendHint(false);
 		if (res != FR_OK) {
 			ESPFAT_DEBUGV("[VFATFSFileImpl::close] Error %d\n", res);
 		}
@@ -1030,34 +1961,127 @@ void VFATFSFileImpl::close() {
 
 // Dir
 
+#if FF_FS_RPATH
+
+// Relative FatFs paths start from the directory set here, for one operation
+// Reset afterwards, so that f_unlink() never mistakes it for a working directory
+class VFATBaseDir {
+public:
+	VFATBaseDir(FATFS& fatfs, const DIR& dir) : _fatfs(fatfs) {
+		_fatfs.cdir = dir.obj.sclust;
+	}
+	~VFATBaseDir() {
+		_fatfs.cdir = 0;
+	}
+
+protected:
+	FATFS& _fatfs;
+};
+
+bool VFATFSDirImpl::childPath(const char* name, String& fpath) const {
+	// Anything other than a plain name goes through path normalization
+	if (!*name || strchr(name, '/')) return false;
+	if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2]))) return false;
+	// The handle must belong to the current mount, its cluster may be reused
+	//  after the volume was remounted or formatted
+	if (!_fs._mounted || _fd.obj.fs != &_fs._fatfs || _fd.obj.id != _fs._fatfs.id)
+		return false;
+
+	fpath = String(_fs._partno);
+	fpath.concat(':');
+	fpath.concat(name);
+	return true;
+}
+
 FileImplPtr VFATFSDirImpl::openFile(const char *name, OpenMode openMode, AccessMode accessMode) {
 	String entrypath = pathJoin(_pathname, name);
-	return _fs.openFile(CSTR_NODRV(entrypath), openMode, accessMode);
+	String fpath, normPath;
+	if (!childPath(name, fpath) || !normalizePath(CSTR_NODRV(entrypath), _fs._partno, normPath))
+		return _fs.openFile(CSTR_NODRV(entrypath), openMode, accessMode);
+
+	VFATBaseDir base(_fs._fatfs, _fd);
+	return _fs.openFileAt(fpath.c_str(), std::move(normPath), openMode, accessMode);
 }
 
 DirImplPtr VFATFSDirImpl::openDir(const char *name, bool create) {
 	String entrypath = pathJoin(_pathname, name);
-	return _fs.openDir(CSTR_NODRV(entrypath), create);
+	String fpath, normPath;
+	if (!childPath(name, fpath) || !normalizePath(CSTR_NODRV(entrypath), _fs._partno, normPath))
+		return _fs.openDir(CSTR_NODRV(entrypath), create);
+
+	VFATBaseDir base(_fs._fatfs, _fd);
+	return _fs.openDirAt(fpath.c_str(), std::move(normPath), create);
 }
 
 bool VFATFSDirImpl::exists(const char *name) const {
+	String fpath;
+	if (!childPath(name, fpath)) {
+		String entrypath = pathJoin(_pathname, name);
+		return _fs.exists(CSTR_NODRV(entrypath));
+	}
+
+	VFATBaseDir base(_fs._fatfs, _fd);
+	FRESULT res = f_stat(fpath.c_str(), NULL);
+	ESPFAT_DEBUGVV("[VFATFSDirImpl::exists] result %d\n", res);
+	return res == FR_OK;
+}
+
+bool VFATFSDirImpl::stat(const char* name, VFATFileStat& st) const {
+	String fpath;
+	if (!childPath(name, fpath)) {
+		String entrypath = pathJoin(_pathname, name);
+		return _fs.stat(CSTR_NODRV(entrypath), st);
+	}
+
+	VFATBaseDir base(_fs._fatfs, _fd);
+	return _fs.statAt(fpath.c_str(), st);
+}
+
+bool VFATFSDirImpl::remove(const char *name) {
+	String fpath;
+	if (!childPath(name, fpath)) {
+		String entrypath = pathJoin(_pathname, name);
+		return _fs.remove(CSTR_NODRV(entrypath));
+	}
+
+	VFATBaseDir base(_fs._fatfs, _fd);
+	return _fs.removeAt(fpath.c_str());
+}
+
+bool VFATFSDirImpl::rename(const char* nameFrom, const char* nameTo) {
+	String fpathFrom, fpathTo;
+	if (!childPath(nameFrom, fpathFrom) || !childPath(nameTo, fpathTo)) {
+		String entrypathFrom = pathJoin(_pathname, nameFrom);
+		String entrypathTo = pathJoin(_pathname, nameTo);
+		return _fs.rename(CSTR_NODRV(entrypathFrom), CSTR_NODRV(entrypathTo));
+	}
+	if (fpathFrom == fpathTo)
+		return true;
+
+	VFATBaseDir base(_fs._fatfs, _fd);
+	return _fs.renameAt(fpathFrom.c_str(), fpathTo.c_str());
+}
+
+#else
+
+FileImplPtr VFATFSDirImpl::openFile(const char *name, OpenMode openMode, AccessMode accessMode) {
 	String entrypath = pathJoin(_pathname, name);
-	return _fs.exists(CSTR_NODRV(entrypath));
+	return _fs.openFile(CSTR_NODRV(entrypath), openMode, accessMode);
 }
 
-bool VFATFSDirImpl::isDir(const char* name) const {
+DirImplPtr VFATFSDirImpl::openDir(const char *name, bool create) {
 	String entrypath = pathJoin(_pathname, name);
-	return _fs.isDir(CSTR_NODRV(entrypath));
+	return _fs.openDir(CSTR_NODRV(entrypath), create);
 }
 
-size_t VFATFSDirImpl::size(const char* name) const {
+bool VFATFSDirImpl::exists(const char *name) const {
 	String entrypath = pathJoin(_pathname, name);
-	return _fs.size(CSTR_NODRV(entrypath));
+	return _fs.exists(CSTR_NODRV(entrypath));
 }
 
-time_t VFATFSDirImpl::mtime(const char* name) const {
+bool VFATFSDirImpl::stat(const char* name, VFATFileStat& st) const {
 	String entrypath = pathJoin(_pathname, name);
-	return _fs.mtime(CSTR_NODRV(entrypath));
+	return _fs.stat(CSTR_NODRV(entrypath), st);
 }
 
 bool VFATFSDirImpl::remove(const char *name) {
@@ -1071,6 +2095,8 @@ bool VFATFSDirImpl::rename(const char* nameFrom, const char* nameTo) {
 	return _fs.rename(CSTR_NODRV(entrypathFrom), CSTR_NODRV(entrypathTo));
 }
 
+#endif
+
 time_t VFATFSDirImpl::entryMtime() const {
 	if (entryStats.fname[0]) {
 		return fattime2unixts(entryStats.ftime, entryStats.fdate);
@@ -1115,6 +2141,21 @@ bool VFATFSDirImpl::renameEntry(const char* nameTo) {
 	return name ? rename(name, nameTo) : false;
 }
 
+bool VFATFSDirImpl::isDir(const char* name) const {
+	VFATFileStat st;
+	return stat(name, st) && st.isDir;
+}
+
+size_t VFATFSDirImpl::size(const char* name) const {
+	VFATFileStat st;
+	return stat(name, st)? st.size : 0;
+}
+
+time_t VFATFSDirImpl::mtime(const char* name) const {
+	VFATFileStat st;
+	return stat(name, st)? st.mtime : 0;
+}
+
 time_t VFATFSDirImpl::mtime() const {
 	return _fs.mtime(CSTR_NODRV(_pathname));
 }
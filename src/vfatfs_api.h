@@ -67,6 +67,8 @@
 #define VFATFS_PHYS_BLOCK		FLASH_SECTOR_SIZE
 #define VFATFS_SECT_PER_PHYS	1	// HAL layer does not handle partial erase
 #define VFATFS_SECTOR_SIZE		(VFATFS_PHYS_BLOCK/VFATFS_SECT_PER_PHYS)
+#define VFATFS_PAGE_SIZE		256	// Flash program granularity
+#define VFATFS_SECT_PAGES		(VFATFS_SECTOR_SIZE/VFATFS_PAGE_SIZE)	// Up to 16
 
 // Enable in-memory cache of trimmed sectors
 // Required to actually enable trim support
@@ -79,20 +81,19 @@
 	//  0 - Not conservative (fastest, incurs unnecessary flash wears after reboot)
 	//  1 - Avoid redundant trim (slower read/write after reboot + some stack for sector probing)
 	//  2 - Avoid all '1' write mark sector dirty write (even slower write)
-	//  3 - Avoid unnecessary erase/write (extra VFATFS_SECTOR_SIZE heap space)
-	//  * Level 3 not implemented yet!
+	//  3 - Avoid unnecessary erase/write (compare with flash content before write)
+	//  * Level 1 and above also apply level 3 to files opened for append
 	#define VFATFS_CONSERVE_LEVEL	1
 
 	// Heap consumption:
 	// Level 0: ~64 bytes per 1MB (~1KB for 16MB)
-	// Level 1,2: ~128 bytes per 1MB (~2KB for 16MB)
-	// Level 3: (Level 1,2) + ~4KB
+	// Level 1,2,3: ~128 bytes per 1MB (~2KB for 16MB)
 
 	#if VFATFS_CONSERVE_LEVEL >= 1
 
 		// How much stack can be use for sector probing
 		// Must be multiple of 4
-		//  and integer divisor of VFATFS_SECTOR_SIZE
+		//  and integer divisor of VFATFS_PAGE_SIZE
 		//  and small enough to NOT overflow stack
 		//  and large enough to have good efficiency
 		#define VFATFS_PROBE_UNIT (VFATFS_SECTOR_SIZE/16)
@@ -104,6 +105,17 @@
 
 	#endif
 
+	// Non-zero erases aligned runs of 16 sectors with one 64KB block erase
+	//  in background trim, lazy trim and multi-sector writes
+	// Note: calls the undocumented ROM routines SPIUnlock and SPIEraseBlock
+	//  directly, bypassing the SDK flash API (SPI idle wait, protected areas)
+	#define VFATFS_BLOCK_ERASE 0
+
+	// Non-zero stores trim cache to the last flash sector when all partitions
+	//  are unmounted, and restores it at next start, avoids re-probing sectors
+	// Note: the last sector is reserved, toggling requires re-partitioning
+	#define VFATFS_TCSTORE 0
+
 	#if !VFATFS_BGTRIM_INTERVAL
 
 		// None-zero enables "lazy" trimming
@@ -116,8 +128,75 @@
 
 #endif
 
+// Number of sectors held in the in-memory write-back sector cache
+// Repeated FAT and directory sector accesses are served from memory,
+//  and dirty sectors are only written back at sync or eviction
+// Each entry consumes VFATFS_SECTOR_SIZE heap space, 0 disables
+// Hint: 2 entries (8KB heap) mostly absorb the FAT / directory updates of
+//  a single writer, sectCacheStats() helps to size it
+#define VFATFS_SECTCACHE 0
+
+// Non-zero aligns partition starts, FAT and data areas to 64KB flash blocks
+//  at partition creation and format time (costs up to 64KB per region)
+// Note: toggling requires re-partitioning and format
+#define VFATFS_LAYOUT_ALIGN 0
+
+#if FF_USE_FASTSEEK
+
+	// Number of cluster link map tables, files opened read-only at or above
+	//  VFATFS_CLMT_MINSIZE take one, so seeks follow the map instead of the FAT chain
+	// Each table consumes VFATFS_CLMT_SIZE*4 bytes, holds up to (size-1)/2 fragments
+	#define VFATFS_CLMT_POOL		4
+	#define VFATFS_CLMT_SIZE		32
+	#define VFATFS_CLMT_MINSIZE		(64*1024)
+
+#endif
+
 using namespace fs;
 
+struct VFATCacheStats {
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t writebacks;
+};
+
+struct VFATFileStat {
+	bool exists;
+	bool isDir;
+	uint8_t attrib;	// AM_RDO, AM_HID, AM_SYS, AM_DIR, AM_ARC
+	size_t size;
+	time_t mtime;	// 0 for the root directory
+};
+
+struct VFATLayoutRegion {
+	uint32_t start;	// Physical flash address
+	uint32_t size;	// Bytes
+	uint32_t align;	// Largest power of 2 dividing start, up to 64KB
+};
+
+struct VFATLayoutInfo {
+	VFATLayoutRegion volume;
+	VFATLayoutRegion fat;
+	VFATLayoutRegion rootdir;	// Empty on FAT32 (root directory is in data area)
+	VFATLayoutRegion data;
+	uint32_t clusterSize;
+};
+
+enum VFATFormatProfile {
+	VFAT_FORMAT_DEFAULT,	// FatFs chooses cluster size, 512 root entries
+	VFAT_FORMAT_SMALLFILES,	// Many small files: sector sized clusters, large root directory
+	VFAT_FORMAT_LARGEFILES,	// Few large files: large clusters, small root directory
+	VFAT_FORMAT_LOGSTORE,	// Log storage: medium clusters, moderate root directory
+};
+
+struct VFATFormatInfo {
+	uint8_t fatType;		// FS_FAT12 on any flash partition
+	uint32_t clusterSize;	// Bytes
+	uint16_t rootEntries;	// 0 on FAT32
+	uint32_t clusters;
+	uint32_t overhead;		// Bytes taken by reserved area, FAT and root directory
+};
+
 class VFATFSImpl;
 
 class VFATPartitions {
@@ -128,6 +207,9 @@ protected:
 	static bool create();
 public:
 	static bool config(uint8_t A, uint8_t B = 0, uint8_t C = 0, uint8_t D = 0);
+#if VFATFS_SECTCACHE
+	static void sectCacheStats(VFATCacheStats& stats, bool reset = false);
+#endif
 };
 
 class VFATFSFileImpl;
@@ -141,15 +223,40 @@ public:
 	bool begin() override;
 	void end() override;
 	bool format() override;
+	// Profiles pick cluster size and root directory entries; flash partitions
+	//  are too small for anything but FAT12
+	// Default profile formats exactly as format() always did
+	// On success, info (if given) describes the volume as created
+	bool format(VFATFormatProfile profile, VFATFormatInfo* info = NULL);
+	bool formatPlan(VFATFormatProfile profile, VFATFormatInfo& info) const;
 	bool info(FSInfo& info) const override;
 
 	bool getLabel(char *label) const;
 	bool setLabel(const char *label);
+	bool layout(VFATLayoutInfo& info) const;
+#if FF_FAT_CACHE
+	bool fatCacheStats(VFATCacheStats& stats, bool reset = false);
+#endif
+#if FF_DIR_INDEX
+	// Heap bytes currently held by directory hash indexes
+	size_t dirIndexHeap() const;
+#endif
+#if FF_PATH_CACHE
+	// Path lookup cache counters (writebacks is always 0)
+	bool pathCacheStats(VFATCacheStats& stats, bool reset = false);
+#endif
+#if FF_NEG_CACHE
+	// Missing path lookups answered from the negative cache (hits) or by a directory walk (misses)
+	bool negCacheStats(VFATCacheStats& stats, bool reset = false);
+#endif
 
 	bool exists(const char* path) const override;
 	bool isDir(const char* path) const override;
 	size_t size(const char* path) const override;
 	time_t mtime(const char* path) const override;
+	// Existence, type, size, mtime and attributes from a single lookup
+	// Returns false (with st.exists cleared) if the path does not exist
+	bool stat(const char* path, VFATFileStat& st) const;
 
 	FileImplPtr openFile(const char* path, OpenMode openMode,
 		AccessMode accessMode) override;
@@ -164,6 +271,14 @@ protected:
 	bool mount();
 	bool unmount();
 
+	// Operations on FatFs paths (may be relative to a directory handle)
+	bool statAt(const char* fpath, VFATFileStat& st) const;
+	FileImplPtr openFileAt(const char* fpath, String && normPath,
+		OpenMode openMode, AccessMode accessMode);
+	DirImplPtr openDirAt(const char* fpath, String && normPath, bool create);
+	bool removeAt(const char* fpath);
+	bool renameAt(const char* fpathFrom, const char* fpathTo);
+
 	FATFS _fatfs;
 	bool _mounted;
 	uint8_t _partno;
@@ -171,8 +286,8 @@ protected:
 
 class VFATFSFileImpl : public FileImpl {
 public:
-	VFATFSFileImpl(VFATFSImpl& fs, FIL fd, String && pathname)
-	: _fs(fs), _fd(fd), _pathname(std::move(pathname)) {}
+	VFATFSFileImpl(VFATFSImpl& fs, FIL fd, String && pathname, bool append = false)
+	: _fs(fs), _fd(fd), _pathname(std::move(pathname)), _append(append) {}
 
 	~VFATFSFileImpl() override {
 		close();
@@ -183,6 +298,10 @@ public:
 	void flush() override;
 	bool seek(uint32_t pos, SeekMode mode) override;
 	bool truncate() override;
+	// Preallocate a contiguous, pre-erased chain for an empty file of known size
+	// Unused part is released on close, flush keeps the reservation
+	// (without extent allocation, file size is set to size instead)
+	bool reserve(size_t size);
 
 	size_t position() const override {
 		MUSTNOTCLOSE();
@@ -209,9 +328,13 @@ protected:
 		while (!_fd.obj.fs) { panic(); }
 	}
 
+	// Let disk layer program appended data without erase where possible
+	void AppendHint(bool enable);
+
 	VFATFSImpl& _fs;
 	FIL _fd;
 	String _pathname;
+	bool _append;
 };
 
 class VFATFSDirImpl : public DirImpl {
@@ -230,6 +353,8 @@ class VFATFSDirImpl : public DirImpl {
 	bool isDir(const char* name) const override;
 	size_t size(const char* name) const override;
 	time_t mtime(const char* name) const override;
+	// Same as VFATFSImpl::stat(), for a child of this directory
+	bool stat(const char* name, VFATFileStat& st) const;
 	bool remove(const char *name) override;
 	bool rename(const char* nameFrom, const char* nameTo) override;
 
@@ -264,6 +389,11 @@ protected:
 	FILINFO entryStats;
 
 	void close();
+#if FF_FS_RPATH
+	// FatFs path of a plain child name, looked up from this directory's cluster
+	// Fails (callers fall back to the full path) if the handle is stale
+	bool childPath(const char* name, String& fpath) const;
+#endif
 };
 
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_VFATFS)